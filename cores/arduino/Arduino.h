@@ -77,6 +77,7 @@ void loop( void ) ;
   #include "WMath.h"
   #include "HardwareSerial.h"
   #include "pulse.h"
+  #include "PwmPin.h"
 #endif
 #include "delay.h"
 #ifdef __cplusplus
@@ -91,6 +92,8 @@ void loop( void ) ;
 #include "wiring_analog.h"
 #include "wiring_shift.h"
 #include "WInterrupts.h"
+#include "IrqPriority.h"
+#include "WorkQueue.h"
 
 // undefine stdlib's abs if encountered
 #ifdef abs
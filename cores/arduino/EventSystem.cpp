@@ -0,0 +1,208 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "EventSystem.h"
+
+#if defined(__SAMD51__)
+#define EVSYS_CLOCKED_CHANNELS  EVSYS_SYNCH_NUM
+#else
+#define EVSYS_CLOCKED_CHANNELS  EVSYS_CHANNELS
+#endif
+
+EventSystemClass EventSystem;
+
+static void enableBusClock()
+{
+#if defined(__SAMD51__)
+  MCLK->APBBMASK.reg |= MCLK_APBBMASK_EVSYS;
+#else
+  PM->APBCMASK.reg |= PM_APBCMASK_EVSYS;
+#endif
+}
+
+// Generator currently selected by the hardware; 0 means the channel is off
+static uint8_t channelGenerator(uint8_t ch)
+{
+#if defined(__SAMD51__)
+  return EVSYS->Channel[ch].CHANNEL.bit.EVGEN;
+#else
+  // A byte write to CHANNEL selects which channel the register reads back
+  *((volatile uint8_t *)&EVSYS->CHANNEL.reg) = ch;
+  return EVSYS->CHANNEL.bit.EVGEN;
+#endif
+}
+
+// Channel (plus one) the user listens to; 0 means none
+static uint8_t userChannel(uint8_t user)
+{
+#if defined(__SAMD51__)
+  return EVSYS->USER[user].reg;
+#else
+  *((volatile uint8_t *)&EVSYS->USER.reg) = user;
+  return EVSYS->USER.bit.CHANNEL;
+#endif
+}
+
+static void setUserChannel(uint8_t user, uint8_t channel)
+{
+#if defined(__SAMD51__)
+  EVSYS->USER[user].reg = channel;
+#else
+  EVSYS->USER.reg = EVSYS_USER_USER(user) | EVSYS_USER_CHANNEL(channel);
+#endif
+}
+
+int EventSystemClass::allocate(bool clocked)
+{
+  enableBusClock();
+
+  const uint8_t count = clocked ? EVSYS_CLOCKED_CHANNELS : EVSYS_CHANNELS;
+
+  // Also skip channels set up directly by code that doesn't use this class
+  for (uint8_t ch = 0; ch < count; ch++) {
+    if (!(_allocated & (1ul << ch)) && channelGenerator(ch) == 0) {
+      _allocated |= 1ul << ch;
+      return ch;
+    }
+  }
+  return -1;
+}
+
+void EventSystemClass::release(int channel)
+{
+  if (channel < 0 || channel >= EVSYS_CHANNELS) {
+    return;
+  }
+
+  for (uint8_t user = 0; user < EVSYS_USERS; user++) {
+    if (userChannel(user) == channel + 1) {
+      setUserChannel(user, 0);
+    }
+  }
+
+#if defined(__SAMD51__)
+  EVSYS->Channel[channel].CHANNEL.reg = 0;
+#else
+  EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(channel);
+#endif
+
+  _allocated &= ~(1ul << channel);
+}
+
+bool EventSystemClass::route(int channel, uint8_t generator, EventPath path, EventEdge edge)
+{
+  if (channel < 0 || channel >= EVSYS_CHANNELS || !(_allocated & (1ul << channel))) {
+    return false;
+  }
+
+  if (path != EVENT_PATH_ASYNCHRONOUS) {
+    if (channel >= EVSYS_CLOCKED_CHANNELS) {
+      return false;
+    }
+    // The clocked paths run from the channel's own GCLK
+#if defined(__SAMD51__)
+    GCLK->PCHCTRL[EVSYS_GCLK_ID_0 + channel].reg = GCLK_PCHCTRL_GEN_GCLK0_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+    while (GCLK->PCHCTRL[EVSYS_GCLK_ID_0 + channel].bit.CHEN == 0);
+#else
+    GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(EVSYS_GCLK_ID_0 + channel));
+    while (GCLK->STATUS.bit.SYNCBUSY == 1);
+#endif
+  } else {
+    edge = EVENT_EDGE_NONE;
+  }
+
+  uint32_t config = EVSYS_CHANNEL_EVGEN(generator) | EVSYS_CHANNEL_PATH(path) | EVSYS_CHANNEL_EDGSEL(edge);
+#if defined(__SAMD51__)
+  EVSYS->Channel[channel].CHANNEL.reg = config;
+#else
+  EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(channel) | config;
+#endif
+  return true;
+}
+
+bool EventSystemClass::addUser(int channel, uint8_t user)
+{
+  if (channel < 0 || channel >= EVSYS_CHANNELS || user >= EVSYS_USERS) {
+    return false;
+  }
+
+  setUserChannel(user, channel + 1);
+  return true;
+}
+
+void EventSystemClass::removeUser(uint8_t user)
+{
+  if (user < EVSYS_USERS) {
+    setUserChannel(user, 0);
+  }
+}
+
+int EventSystemClass::connect(uint8_t generator, uint8_t user, EventPath path, EventEdge edge)
+{
+  int channel = allocate(path != EVENT_PATH_ASYNCHRONOUS);
+  if (channel < 0) {
+    return -1;
+  }
+
+  // Attach the user first so it can't see a stray event from the old setup
+  if (!addUser(channel, user) || !route(channel, generator, path, edge)) {
+    release(channel);
+    return -1;
+  }
+  return channel;
+}
+
+void EventSystemClass::trigger(int channel)
+{
+  if (channel < 0 || channel >= EVSYS_CHANNELS) {
+    return;
+  }
+
+#if defined(__SAMD51__)
+  EVSYS->SWEVT.reg = 1ul << channel;
+#else
+  // CHANNEL is written as a whole, so keep the channel's configuration
+  *((volatile uint8_t *)&EVSYS->CHANNEL.reg) = channel;
+  EVSYS->CHANNEL.reg = EVSYS->CHANNEL.reg | EVSYS_CHANNEL_SWEVT;
+#endif
+}
+
+bool EventSystemClass::usersReady(int channel)
+{
+  if (channel < 0 || channel >= EVSYS_CLOCKED_CHANNELS) {
+    return true;
+  }
+
+#if defined(__SAMD51__)
+  return EVSYS->Channel[channel].CHSTATUS.bit.RDYUSR;
+#else
+  if (channel < 8) {
+    return EVSYS->CHSTATUS.reg & (EVSYS_CHSTATUS_USRRDY0 << channel);
+  }
+  return EVSYS->CHSTATUS.reg & (EVSYS_CHSTATUS_USRRDY8 << (channel - 8));
+#endif
+}
+
+int EventSystemClass::pinGenerator(uint32_t pin, uint32_t mode)
+{
+  int line = attachInterruptEvent(pin, mode);
+  if (line < 0) {
+    return -1;
+  }
+  return EVSYS_ID_GEN_EIC_EXTINT_0 + line;
+}
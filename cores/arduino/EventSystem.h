@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+
+/*
+ * How an event travels from generator to users. Asynchronous is the
+ * fastest and works in sleep, but only passes the generator's signal
+ * through; the other paths are clocked (GCLK0), can detect edges and
+ * report user readiness, and are needed by some users (see the datasheet
+ * of the peripheral). On SAMD51 only channels 0-11 have a clocked path.
+ */
+enum EventPath {
+  EVENT_PATH_SYNCHRONOUS = 0,
+  EVENT_PATH_RESYNCHRONIZED = 1,
+  EVENT_PATH_ASYNCHRONOUS = 2
+};
+
+// Edge detection for the clocked paths; the asynchronous path needs NONE
+enum EventEdge {
+  EVENT_EDGE_NONE = 0,
+  EVENT_EDGE_RISING = 1,
+  EVENT_EDGE_FALLING = 2,
+  EVENT_EDGE_BOTH = 3
+};
+
+/*
+ * Routes events between peripherals through the event system, so one
+ * peripheral can trigger another without an interrupt.
+ *
+ * Generators and users are the EVSYS_ID_GEN_* and EVSYS_ID_USER_* values
+ * from the device headers, e.g. EVSYS_ID_GEN_TC3_OVF, EVSYS_ID_GEN_RTC_OVF,
+ * EVSYS_ID_GEN_ADC_RESRDY (ADC0_RESRDY on SAMD51) as generators and
+ * EVSYS_ID_USER_ADC_START, EVSYS_ID_USER_DAC_START, EVSYS_ID_USER_TC3_EVU,
+ * EVSYS_ID_USER_DMAC_CH_0 as users. The generating and receiving
+ * peripherals still have to be told to emit or act on the event in their
+ * own EVCTRL registers; pinGenerator() does that for the EIC.
+ *
+ * Example, an ADC conversion on every TC3 overflow:
+ *   int ch = EventSystem.connect(EVSYS_ID_GEN_TC3_OVF, EVSYS_ID_USER_ADC_START);
+ */
+class EventSystemClass
+{
+public:
+  // Reserves a free channel; -1 if there is none. Pass true to get one
+  // with a clocked path (relevant on SAMD51 only).
+  int allocate(bool clocked = false);
+
+  // Disconnects all users of the channel and frees it
+  void release(int channel);
+
+  // Selects the generator of an allocated channel
+  bool route(int channel, uint8_t generator, EventPath path = EVENT_PATH_ASYNCHRONOUS,
+             EventEdge edge = EVENT_EDGE_NONE);
+
+  // A user listens to one channel; a channel may have many users
+  bool addUser(int channel, uint8_t user);
+  void removeUser(uint8_t user);
+
+  // allocate(), route() and addUser() in one; returns the channel or -1
+  int connect(uint8_t generator, uint8_t user, EventPath path = EVENT_PATH_ASYNCHRONOUS,
+              EventEdge edge = EVENT_EDGE_NONE);
+
+  // Fires the channel from software
+  void trigger(int channel);
+
+  // For the clocked paths: all users have handled the last event
+  bool usersReady(int channel);
+
+  // Puts the pin's EXTINT line in event mode (see attachInterruptEvent())
+  // and returns its generator ID, or -1 if the pin has no EXTINT line
+  static int pinGenerator(uint32_t pin, uint32_t mode);
+
+private:
+  uint32_t _allocated;
+};
+
+extern EventSystemClass EventSystem;
+
+#endif
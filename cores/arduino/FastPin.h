@@ -0,0 +1,116 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+
+/*
+ * GPIO access resolved entirely at compile time.
+ *
+ * The pin is named by its PORT group and bit (FastPin<PORTA, 17> for PA17)
+ * rather than by Arduino pin number: g_APinDescription[] is defined in each
+ * variant's .cpp file, so it can't be read by the compiler. Every call
+ * compiles to a single store or load with constant address and mask.
+ *
+ * On SAMD21 the data registers are accessed through the IOBUS alias of
+ * PORT, which the CPU reaches in one cycle instead of going through the
+ * APB bridge. The SAMD51 has no IOBUS and uses PORT directly.
+ *
+ * Example:
+ *   typedef FastPin<PORTA, 17> Led;   // D13 on the Zero
+ *   Led::output();
+ *   Led::toggle();
+ */
+template<EPortType P, uint32_t B>
+class FastPin
+{
+public:
+  static_assert(P >= PORTA, "FastPin needs a real PORT group");
+  static_assert(B < 32, "FastPin bit must be 0..31");
+
+  static const uint32_t mask = 1ul << B;
+
+  // Same configurations as pinMode(); these go through the APB port
+  static inline void output()
+  {
+    PORT->Group[P].PINCFG[B].reg = (uint8_t)(PORT_PINCFG_INEN);
+    PORT->Group[P].DIRSET.reg = mask;
+    sampleContinuously();
+  }
+
+  static inline void input()
+  {
+    PORT->Group[P].PINCFG[B].reg = (uint8_t)(PORT_PINCFG_INEN);
+    PORT->Group[P].DIRCLR.reg = mask;
+    sampleContinuously();
+  }
+
+  static inline void inputPullup()
+  {
+    PORT->Group[P].PINCFG[B].reg = (uint8_t)(PORT_PINCFG_INEN|PORT_PINCFG_PULLEN);
+    PORT->Group[P].DIRCLR.reg = mask;
+    PORT->Group[P].OUTSET.reg = mask;
+    sampleContinuously();
+  }
+
+  static inline void inputPulldown()
+  {
+    PORT->Group[P].PINCFG[B].reg = (uint8_t)(PORT_PINCFG_INEN|PORT_PINCFG_PULLEN);
+    PORT->Group[P].DIRCLR.reg = mask;
+    PORT->Group[P].OUTCLR.reg = mask;
+    sampleContinuously();
+  }
+
+  static inline void high()   { group()->OUTSET.reg = mask; }
+  static inline void low()    { group()->OUTCLR.reg = mask; }
+  static inline void toggle() { group()->OUTTGL.reg = mask; }
+
+  static inline void write(bool value)
+  {
+    if (value) {
+      high();
+    } else {
+      low();
+    }
+  }
+
+  static inline bool read() { return (group()->IN.reg & mask) != 0; }
+
+private:
+  static inline PortGroup *group()
+  {
+#if defined(PORT_IOBUS) && !defined(__SAMD51__)
+    return &PORT_IOBUS->Group[P];
+#else
+    return &PORT->Group[P];
+#endif
+  }
+
+  // IN can only be read over the IOBUS with continuous sampling enabled
+  static inline void sampleContinuously()
+  {
+#if defined(PORT_IOBUS) && !defined(__SAMD51__)
+    PORT->Group[P].CTRL.reg |= mask;
+#endif
+  }
+};
+
+#endif
@@ -0,0 +1,218 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "ISRProfiler.h"
+
+#if defined(ISR_PROFILER)
+
+#if defined(__SAMD51__)
+// VTOR needs the table aligned to its size rounded up to a power of two
+#define VECTOR_ALIGN    1024
+#define PENDING_WORDS   ((PERIPH_COUNT_IRQn + 31) / 32)
+#else
+#define VECTOR_ALIGN    256
+#define PENDING_WORDS   1
+#endif
+
+#define VECTOR_COUNT    (16 + PERIPH_COUNT_IRQn)
+
+extern "C" const DeviceVectors exception_table;
+
+static void * const *flashVectors = (void * const *)&exception_table;
+static void *ramVectors[VECTOR_COUNT] __attribute__ ((aligned(VECTOR_ALIGN)));
+
+static ISRProfile profiles[ISR_PROFILER_ENTRIES];
+static uint32_t pendingSince[ISR_PROFILER_ENTRIES];
+static uint32_t pendingSeen[(ISR_PROFILER_ENTRIES + 31) / 32];
+
+// Time spent in handlers, for nested handlers to discount from the ones they preempted
+static volatile uint32_t handlerCycles;
+
+#if defined(__SAMD51__)
+static inline uint32_t now(void)
+{
+  return DWT->CYCCNT;
+}
+
+static inline uint32_t elapsed(uint32_t from, uint32_t to)
+{
+  return to - from;
+}
+#else
+static inline uint32_t now(void)
+{
+  return SysTick->VAL;
+}
+
+// SysTick counts down and reloads from LOAD every millisecond
+static inline uint32_t elapsed(uint32_t from, uint32_t to)
+{
+  return (from >= to) ? from - to : from + SysTick->LOAD + 1 - to;
+}
+#endif
+
+static inline void markPending(uint32_t entry, uint32_t time)
+{
+  uint32_t bit = 1ul << (entry & 31);
+  if (!(pendingSeen[entry >> 5] & bit)) {
+    pendingSeen[entry >> 5] |= bit;
+    pendingSince[entry] = time;
+  }
+}
+
+// Records the first time each waiting interrupt is seen pending
+static void scanPending(uint32_t time)
+{
+  uint32_t icsr = SCB->ICSR;
+  if (icsr & SCB_ICSR_PENDSVSET_Msk) markPending(ISR_PROFILER_PENDSV, time);
+  if (icsr & SCB_ICSR_PENDSTSET_Msk) markPending(ISR_PROFILER_SYSTICK, time);
+
+  for (uint32_t w = 0; w < PENDING_WORDS; w++) {
+    uint32_t pending = NVIC->ISPR[w];
+    while (pending) {
+      uint32_t n = __builtin_ctz(pending);
+      pending &= pending - 1;
+      markPending(ISR_PROFILER_IRQ(w * 32 + n), time);
+    }
+  }
+}
+
+static void profileCall(uint32_t entry, void (*handler)(void))
+{
+  uint32_t start = now();
+  ISRProfile *p = &profiles[entry];
+  uint32_t bit = 1ul << (entry & 31);
+
+  if (pendingSeen[entry >> 5] & bit) {
+    uint32_t latency = elapsed(pendingSince[entry], start);
+    if (latency > p->maxLatencyCycles) p->maxLatencyCycles = latency;
+    pendingSeen[entry >> 5] &= ~bit;
+  }
+  scanPending(start);
+
+  uint32_t nestedBefore = handlerCycles;
+  handler();
+  uint32_t end = now();
+
+  uint32_t total = elapsed(start, end);
+  uint32_t self = total - (handlerCycles - nestedBefore);
+  handlerCycles = nestedBefore + total;
+
+  p->count++;
+  p->totalCycles += self;
+  if (self > p->maxCycles) p->maxCycles = self;
+
+  scanPending(end);
+}
+
+static void profiledHandler(void)
+{
+  uint32_t exception = __get_IPSR() & 0x1FF;
+
+  // PendSV is exception 14
+  profileCall(exception - 14, (void (*)(void))flashVectors[exception]);
+}
+
+extern "C" void isrProfilerPendSV(void (*work)(void))
+{
+  profileCall(ISR_PROFILER_PENDSV, work);
+}
+
+extern "C" void isrProfilerInstall(void)
+{
+  // The original handlers stay in flash, where profiledHandler() finds them.
+  // PendSV isn't wrapped: switching tasks needs its EXC_RETURN in lr. The
+  // work queue reports its part through isrProfilerPendSV() instead.
+  for (uint32_t i = 0; i < VECTOR_COUNT; i++) {
+    ramVectors[i] = (i >= 15 && flashVectors[i] != NULL) ? (void *)profiledHandler : flashVectors[i];
+  }
+
+  __disable_irq();
+  SCB->VTOR = (uint32_t)ramVectors;
+  __DSB();
+  __enable_irq();
+}
+
+extern "C" void isrProfilerReset(void)
+{
+  __disable_irq();
+  memset(profiles, 0, sizeof(profiles));
+  memset(pendingSeen, 0, sizeof(pendingSeen));
+  __enable_irq();
+}
+
+extern "C" bool isrProfilerGet(uint32_t entry, ISRProfile *profile)
+{
+  if (entry >= ISR_PROFILER_ENTRIES) {
+    return false;
+  }
+
+  __disable_irq();
+  *profile = profiles[entry];
+  __enable_irq();
+  return profile->count != 0;
+}
+
+static void printMicros(Print &out, uint32_t cycles)
+{
+  // Two decimals: enough for a few-cycle handler at 48MHz
+  uint32_t hundredths = (uint32_t)(((uint64_t)cycles * 100) / (VARIANT_MCK / 1000000));
+  out.print(hundredths / 100);
+  out.print('.');
+  if (hundredths % 100 < 10) out.print('0');
+  out.print(hundredths % 100);
+}
+
+void isrProfilerPrint(Print &out)
+{
+  out.println(F("IRQ\tcount\tavg us\tmax us\tmax latency us"));
+
+  for (uint32_t entry = 0; entry < ISR_PROFILER_ENTRIES; entry++) {
+    ISRProfile p;
+    if (!isrProfilerGet(entry, &p)) {
+      continue;
+    }
+
+    if (entry == ISR_PROFILER_PENDSV) {
+      out.print(F("PendSV"));
+    } else if (entry == ISR_PROFILER_SYSTICK) {
+      out.print(F("SysTick"));
+    } else {
+      out.print(entry - ISR_PROFILER_IRQ(0));
+    }
+    out.print('\t');
+    out.print(p.count);
+    out.print('\t');
+    printMicros(out, (uint32_t)(p.totalCycles / p.count));
+    out.print('\t');
+    printMicros(out, p.maxCycles);
+    out.print('\t');
+    printMicros(out, p.maxLatencyCycles);
+    out.println();
+  }
+}
+
+#else
+
+void isrProfilerPrint(Print &out)
+{
+  out.println(F("ISR profiler not compiled in (define ISR_PROFILER)"));
+}
+
+#endif // ISR_PROFILER
@@ -0,0 +1,87 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Interrupt profiler, compiled in only when ISR_PROFILER is defined for the
+ * whole core (e.g. compiler.c.extra_flags=-DISR_PROFILER and
+ * compiler.cpp.extra_flags=-DISR_PROFILER in platform.local.txt).
+ *
+ * Before main() runs, the vector table is copied to RAM with SysTick and
+ * every peripheral entry pointed at a wrapper, which times the original
+ * handler and then calls it. PendSV is left alone, as the task switch in
+ * it can't run from a wrapper; its entry times the deferred interrupt work
+ * run by workQueueRun() instead (see WorkQueue.h), without the task switch.
+ * Times are CPU cycles from DWT->CYCCNT on SAMD51. On SAMD21 they come from SysTick->VAL, so a
+ * single handler run longer than 1ms is not measured correctly.
+ *
+ * Time spent in a handler that preempts another is not charged to the
+ * preempted one. Latency is the time from when a wrapper first sees an
+ * interrupt pending until its handler starts. It is therefore the delay
+ * caused by other handlers only. Code running with interrupts disabled is
+ * not covered.
+ */
+
+// Index of PendSV and SysTick; peripheral IRQ n is ISR_PROFILER_IRQ(n)
+#define ISR_PROFILER_PENDSV    0
+#define ISR_PROFILER_SYSTICK   1
+#define ISR_PROFILER_IRQ(n)    ((n) + 2)
+#define ISR_PROFILER_ENTRIES   ISR_PROFILER_IRQ(PERIPH_COUNT_IRQn)
+
+typedef struct {
+  uint32_t count;
+  uint64_t totalCycles;
+  uint32_t maxCycles;
+  uint32_t maxLatencyCycles;
+} ISRProfile;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(ISR_PROFILER)
+
+void isrProfilerInstall(void);
+void isrProfilerReset(void);
+
+// Copies the statistics of one entry; false if it never ran
+bool isrProfilerGet(uint32_t entry, ISRProfile *profile);
+
+// Runs work, timed as the PendSV entry; called by workQueueRun()
+void isrProfilerPendSV(void (*work)(void));
+
+#else
+
+static inline void isrProfilerReset(void) { }
+static inline bool isrProfilerGet(uint32_t entry, ISRProfile *profile) { (void)entry; (void)profile; return false; }
+
+#endif
+
+#ifdef __cplusplus
+} // extern "C"
+
+#include "Print.h"
+
+// Prints a table of every interrupt that ran, times in microseconds
+void isrProfilerPrint(Print &out);
+
+#endif
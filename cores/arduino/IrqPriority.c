@@ -0,0 +1,139 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "IrqPriority.h"
+
+#ifndef IRQ_PRIORITY_EIC
+#define IRQ_PRIORITY_EIC      0
+#endif
+#ifndef IRQ_PRIORITY_USB
+#define IRQ_PRIORITY_USB      0
+#endif
+#ifndef IRQ_PRIORITY_SERCOM
+#define IRQ_PRIORITY_SERCOM   IRQ_PRIORITY_LOWEST
+#endif
+#ifndef IRQ_PRIORITY_DMA
+#define IRQ_PRIORITY_DMA      IRQ_PRIORITY_LOWEST
+#endif
+#ifndef IRQ_PRIORITY_ADC
+#define IRQ_PRIORITY_ADC      IRQ_PRIORITY_LOWEST
+#endif
+#ifndef IRQ_PRIORITY_TONE
+#if defined(__SAMD51__)
+#define IRQ_PRIORITY_TONE     5
+#else
+// What the former NVIC_SetPriority(TONE_TC_IRQn, 5) ended up as with 2 priority bits
+#define IRQ_PRIORITY_TONE     1
+#endif
+#endif
+#ifndef IRQ_PRIORITY_SERVO
+#define IRQ_PRIORITY_SERVO    0
+#endif
+#ifndef IRQ_PRIORITY_SYSTICK
+#define IRQ_PRIORITY_SYSTICK  (IRQ_PRIORITY_LOWEST - 1)
+#endif
+#ifndef IRQ_PRIORITY_PENDSV
+// Below everything else, so deferred work never delays an interrupt
+#define IRQ_PRIORITY_PENDSV   IRQ_PRIORITY_LOWEST
+#endif
+
+// Index of IRQn in irqClassOf[]; covers PendSV and SysTick as well
+#define IRQ_INDEX(irqn)       ((irqn) - PendSV_IRQn)
+#define IRQ_INDEX_COUNT       IRQ_INDEX(PERIPH_COUNT_IRQn)
+
+static uint8_t priorities[IRQ_CLASS_COUNT] = {
+  IRQ_PRIORITY_EIC,
+  IRQ_PRIORITY_USB,
+  IRQ_PRIORITY_SERCOM,
+  IRQ_PRIORITY_DMA,
+  IRQ_PRIORITY_ADC,
+  IRQ_PRIORITY_TONE,
+  IRQ_PRIORITY_SERVO,
+  IRQ_PRIORITY_SYSTICK,
+  IRQ_PRIORITY_PENDSV,
+};
+
+// Class + 1 of each assigned IRQ, 0 if none
+static uint8_t irqClassOf[IRQ_INDEX_COUNT];
+
+static uint32_t inversions[IRQ_CLASS_COUNT];
+
+uint8_t irqPriority(IrqClass cls)
+{
+  return cls < IRQ_CLASS_COUNT ? priorities[cls] : IRQ_PRIORITY_LOWEST;
+}
+
+void setIrqPriority(IrqClass cls, uint8_t priority)
+{
+  if (cls >= IRQ_CLASS_COUNT) return;
+  if (priority > IRQ_PRIORITY_LOWEST) priority = IRQ_PRIORITY_LOWEST;
+
+  priorities[cls] = priority;
+
+  for (int32_t i = 0; i < IRQ_INDEX_COUNT; i++) {
+    if (irqClassOf[i] == cls + 1) {
+      NVIC_SetPriority((IRQn_Type)(i + PendSV_IRQn), priority);
+    }
+  }
+}
+
+void irqAssignPriority(IRQn_Type irqn, IrqClass cls)
+{
+  if (cls >= IRQ_CLASS_COUNT) return;
+
+  if (irqn >= PendSV_IRQn && irqn < PERIPH_COUNT_IRQn) {
+    irqClassOf[IRQ_INDEX(irqn)] = cls + 1;
+  }
+  NVIC_SetPriority(irqn, priorities[cls]);
+}
+
+bool irqBlockedHere(IrqClass cls)
+{
+  uint32_t exception = SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk;
+  bool blocked;
+
+  if (__get_PRIMASK() & 0x1) {
+    blocked = true;
+  } else if (exception == 0) {
+    blocked = false;
+  } else {
+    blocked = NVIC_GetPriority((IRQn_Type)(exception - 16)) <= irqPriority(cls);
+  }
+
+#if defined(IRQ_PRIORITY_CHECK)
+  if (blocked) {
+    inversions[cls]++;
+    irqPriorityInversion(cls, exception);
+  }
+#endif
+
+  return blocked;
+}
+
+uint32_t irqInversionCount(IrqClass cls)
+{
+  return cls < IRQ_CLASS_COUNT ? inversions[cls] : 0;
+}
+
+void irqPriorityInversion(IrqClass cls, uint32_t exception) __attribute__ ((weak));
+void irqPriorityInversion(IrqClass cls, uint32_t exception)
+{
+  (void)cls;
+  (void)exception;
+}
@@ -0,0 +1,77 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sam.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Interrupt priorities of the core drivers, kept in one table by class.
+ *
+ * Each driver assigns its IRQs with irqAssignPriority() instead of a
+ * hard-coded NVIC_SetPriority(). The defaults (IRQ_PRIORITY_* in
+ * IrqPriority.c) keep the historical values and may be overridden by
+ * defining them in variant.h. A sketch can call setIrqPriority() at any
+ * time; IRQs already assigned to the class are updated as well.
+ *
+ * Lower numbers preempt higher ones: 0-3 on SAMD21, 0-7 on SAMD51.
+ */
+typedef enum _IrqClass
+{
+  IRQ_CLASS_EIC = 0,
+  IRQ_CLASS_USB,
+  IRQ_CLASS_SERCOM,
+  IRQ_CLASS_DMA,
+  IRQ_CLASS_ADC,
+  IRQ_CLASS_TONE,
+  IRQ_CLASS_SERVO,
+  IRQ_CLASS_SYSTICK,
+  IRQ_CLASS_PENDSV,   // Deferred work and task switches; must stay the lowest
+  IRQ_CLASS_COUNT
+} IrqClass;
+
+#define IRQ_PRIORITY_LOWEST ((1 << __NVIC_PRIO_BITS) - 1)
+
+uint8_t irqPriority(IrqClass cls);
+void setIrqPriority(IrqClass cls, uint8_t priority);
+
+// Sets irqn to the priority of cls and remembers it for setIrqPriority()
+void irqAssignPriority(IRQn_Type irqn, IrqClass cls);
+
+/*
+ * For drivers about to wait on one of their own interrupts: true if it
+ * can't run from here, because interrupts are off or the current handler
+ * has the same or a higher priority. The driver then has to poll instead.
+ *
+ * With IRQ_PRIORITY_CHECK defined each such case is counted and reported
+ * to irqPriorityInversion(), which a sketch may define, e.g. to log it.
+ */
+bool irqBlockedHere(IrqClass cls);
+
+uint32_t irqInversionCount(IrqClass cls);
+void irqPriorityInversion(IrqClass cls, uint32_t exception);
+
+#ifdef __cplusplus
+}
+#endif
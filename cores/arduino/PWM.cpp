@@ -0,0 +1,389 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PWM.h"
+#include "wiring_private.h"
+
+// Per-TCC features, indexed by TCC number
+static const uint8_t tccSize[] = {
+  TCC0_SIZE, TCC1_SIZE, TCC2_SIZE,
+#ifdef TCC3_SIZE
+  TCC3_SIZE,
+#endif
+#ifdef TCC4_SIZE
+  TCC4_SIZE,
+#endif
+};
+
+static const uint8_t tccChannels[] = {
+  TCC0_CC_NUM, TCC1_CC_NUM, TCC2_CC_NUM,
+#ifdef TCC3_CC_NUM
+  TCC3_CC_NUM,
+#endif
+#ifdef TCC4_CC_NUM
+  TCC4_CC_NUM,
+#endif
+};
+
+#if defined(__SAMD51__)
+static const uint8_t tccOutputs[] = {
+  TCC0_OW_NUM, TCC1_OW_NUM, TCC2_OW_NUM,
+#ifdef TCC3_OW_NUM
+  TCC3_OW_NUM,
+#endif
+#ifdef TCC4_OW_NUM
+  TCC4_OW_NUM,
+#endif
+};
+#endif
+
+static const uint8_t tccDeadTime[] = {
+  TCC0_DTI, TCC1_DTI, TCC2_DTI,
+#ifdef TCC3_DTI
+  TCC3_DTI,
+#endif
+#ifdef TCC4_DTI
+  TCC4_DTI,
+#endif
+};
+
+// CTRLA.PRESCALER values are log2 of these divisions
+static const uint8_t prescalerShift[] = {0, 1, 2, 3, 4, 6, 8, 10};
+
+static inline void syncTCC(Tcc *TCCx)
+{
+  while (TCCx->SYNCBUSY.reg);
+}
+
+static inline void disableTCC(Tcc *TCCx)
+{
+  TCCx->CTRLA.bit.ENABLE = 0;
+  syncTCC(TCCx);
+}
+
+static inline void enableTCC(Tcc *TCCx)
+{
+  TCCx->CTRLA.bit.ENABLE = 1;
+  syncTCC(TCCx);
+}
+
+// Same pin muxing as analogWrite()
+static void pinTimer(uint32_t pin)
+{
+  uint32_t attr = g_APinDescription[pin].ulPinAttribute;
+
+#if defined(__SAMD51__)
+  if (attr & PIN_ATTR_PWM_E)
+    pinPeripheral(pin, PIO_TIMER);
+  else if (attr & PIN_ATTR_PWM_F)
+    pinPeripheral(pin, PIO_TIMER_ALT);
+  else if (attr & PIN_ATTR_PWM_G)
+    pinPeripheral(pin, PIO_TCC_PDEC);
+#else
+  if (attr & PIN_ATTR_TIMER)
+    pinPeripheral(pin, PIO_TIMER);
+  else if ((attr & PIN_ATTR_TIMER_ALT) == PIN_ATTR_TIMER_ALT)
+    pinPeripheral(pin, PIO_TIMER_ALT);
+#endif
+}
+
+PWM::PWM(uint32_t pin) :
+  _tcc(NULL),
+  _tcNum(0),
+  _prescaler(0),
+  _centerAligned(false),
+  _period(0),
+  _pin(pin)
+{
+  if (pin >= PINS_COUNT) {
+    return;
+  }
+
+  int32_t pwmChannel = g_APinDescription[pin].ulPWMChannel;
+
+  if (pwmChannel != NOT_ON_PWM && GetTCNumber(pwmChannel) < TCC_INST_NUM) {
+    _tcNum = GetTCNumber(pwmChannel);
+    _tcc = (Tcc *)GetTC(pwmChannel);
+  }
+}
+
+bool PWM::pinChannel(uint32_t pin, uint8_t *channel, uint8_t *output) const
+{
+  if (pin >= PINS_COUNT) {
+    return false;
+  }
+
+  int32_t pwmChannel = g_APinDescription[pin].ulPWMChannel;
+
+  if (!_tcc || pwmChannel == NOT_ON_PWM || GetTCNumber(pwmChannel) != _tcNum) {
+    return false;
+  }
+
+  uint8_t wo = GetTCChannelNumber(pwmChannel);
+#if defined(__SAMD51__)
+  // The SAMD51 tables hold the WO number; with OTMX=0, WO[x] follows CC[x % n]
+  *output = wo;
+  *channel = wo % tccChannels[_tcNum];
+#else
+  // The SAMD21 tables already fold WO[x] onto its CC channel
+  *output = 0xFF;
+  *channel = wo;
+#endif
+  return true;
+}
+
+bool PWM::begin(uint32_t frequency, bool centerAligned)
+{
+  if (!_tcc) {
+    return false;
+  }
+
+#if defined(__SAMD51__)
+  GCLK->PCHCTRL[GCLK_CLKCTRL_IDs[_tcNum]].reg = GCLK_PCHCTRL_GEN_GCLK0_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+  while (GCLK->PCHCTRL[GCLK_CLKCTRL_IDs[_tcNum]].bit.CHEN == 0);
+#else
+  static const uint16_t GCLK_CLKCTRL_IDs[] = {
+    GCLK_CLKCTRL_ID(GCM_TCC0_TCC1), // TCC0
+    GCLK_CLKCTRL_ID(GCM_TCC0_TCC1), // TCC1
+    GCLK_CLKCTRL_ID(GCM_TCC2_TC3),  // TCC2
+  };
+  GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_IDs[_tcNum]);
+  while (GCLK->STATUS.bit.SYNCBUSY == 1);
+#endif
+
+  disableTCC(_tcc);
+  _tcc->CTRLA.reg = TCC_CTRLA_SWRST;
+  while (_tcc->SYNCBUSY.bit.SWRST);
+
+  _centerAligned = centerAligned;
+
+  if (!setFrequency(frequency)) {
+    return false;
+  }
+
+  return attach(_pin);
+}
+
+void PWM::end()
+{
+  if (_tcc) {
+    disableTCC(_tcc);
+  }
+}
+
+bool PWM::setFrequency(uint32_t frequency)
+{
+  if (!_tcc || frequency == 0) {
+    return false;
+  }
+
+  uint32_t top = (1UL << tccSize[_tcNum]) - 1;
+  uint32_t slopes = _centerAligned ? 2 : 1;
+
+  for (uint8_t i = 0; i < sizeof(prescalerShift); i++) {
+    uint32_t period = (F_CPU >> prescalerShift[i]) / (frequency * slopes);
+    // PER holds period - 1 in single slope and period in dual slope
+    if (period >= 2 && period - (_centerAligned ? 0 : 1) <= top) {
+      return configure(period, i);
+    }
+  }
+
+  return false;
+}
+
+bool PWM::setPeriod(uint32_t period, uint16_t prescaler)
+{
+  if (!_tcc || period < 2) {
+    return false;
+  }
+
+  uint32_t top = (1UL << tccSize[_tcNum]) - 1;
+  if (period - (_centerAligned ? 0 : 1) > top) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < sizeof(prescalerShift); i++) {
+    if ((1U << prescalerShift[i]) == prescaler) {
+      return configure(period, i);
+    }
+  }
+
+  return false;
+}
+
+bool PWM::configure(uint32_t period, uint8_t prescaler)
+{
+  uint32_t per = _centerAligned ? period : period - 1;
+
+  if (_tcc->CTRLA.bit.ENABLE && prescaler == _prescaler) {
+    // Buffered, so the running period finishes first
+#if defined(__SAMD51__)
+    _tcc->PERBUF.reg = per;
+#else
+    _tcc->PERB.reg = per;
+#endif
+    _period = period;
+    return true;
+  }
+
+  disableTCC(_tcc);
+
+  _tcc->CTRLA.reg = TCC_CTRLA_PRESCALER(prescaler) | TCC_CTRLA_PRESCSYNC_PRESC;
+  _tcc->WAVE.reg = _centerAligned ? TCC_WAVE_WAVEGEN_DSBOTTOM : TCC_WAVE_WAVEGEN_NPWM;
+  syncTCC(_tcc);
+  _tcc->PER.reg = per;
+  syncTCC(_tcc);
+
+  enableTCC(_tcc);
+
+  _prescaler = prescaler;
+  _period = period;
+  return true;
+}
+
+uint32_t PWM::frequency() const
+{
+  if (!_period) {
+    return 0;
+  }
+
+  return (F_CPU >> prescalerShift[_prescaler]) / (_period * (_centerAligned ? 2 : 1));
+}
+
+bool PWM::attach(uint32_t pin)
+{
+  uint8_t channel, output;
+
+  if (!pinChannel(pin, &channel, &output)) {
+    return false;
+  }
+
+  write(pin, 0);
+  pinTimer(pin);
+  return true;
+}
+
+uint32_t PWM::nsToDeadTime(uint32_t ns) const
+{
+  // DTI counts undivided GCLK_TCC cycles; round up so the gap is never short
+  return (ns * (F_CPU / 1000000) + 999) / 1000;
+}
+
+bool PWM::attachComplementary(uint32_t pin, uint32_t complementPin, uint32_t deadTimeNs)
+{
+  uint8_t channel, output, complementChannel, complementOutput;
+
+  if (!pinChannel(pin, &channel, &output) ||
+      !pinChannel(complementPin, &complementChannel, &complementOutput) ||
+      !tccDeadTime[_tcNum]) {
+    return false;
+  }
+
+  // Two pin numbers for the same pad can't be a pair either
+  if (g_APinDescription[pin].ulPort == g_APinDescription[complementPin].ulPort &&
+      g_APinDescription[pin].ulPin == g_APinDescription[complementPin].ulPin) {
+    return false;
+  }
+
+#if defined(__SAMD51__)
+  // DTI unit x drives WO[x] from CC[x] and its complement on WO[x + n/2]
+  uint8_t half = tccOutputs[_tcNum] / 2;
+  (void)complementChannel;
+  if (output >= half || complementOutput != output + half) {
+    return false;
+  }
+  channel = output;
+#else
+  // The SAMD21 tables fold WO[x] and WO[x + 4] onto CC[x] alike, so only
+  // the channel can be checked; which pin is which side is up to the caller
+  (void)output;
+  (void)complementOutput;
+  if (complementChannel != channel) {
+    return false;
+  }
+#endif
+
+  uint32_t deadTime = nsToDeadTime(deadTimeNs);
+  if (channel >= 4 || deadTime > 0xFF) {
+    return false;
+  }
+
+  // WEXCTRL is enable-protected
+  disableTCC(_tcc);
+  uint32_t wexctrl = _tcc->WEXCTRL.reg;
+  wexctrl &= ~(TCC_WEXCTRL_OTMX_Msk | TCC_WEXCTRL_DTLS_Msk | TCC_WEXCTRL_DTHS_Msk);
+  wexctrl |= (TCC_WEXCTRL_DTIEN0 << channel) | TCC_WEXCTRL_DTLS(deadTime) | TCC_WEXCTRL_DTHS(deadTime);
+  _tcc->WEXCTRL.reg = wexctrl;
+  enableTCC(_tcc);
+
+  write(pin, 0);
+  pinTimer(pin);
+  pinTimer(complementPin);
+  return true;
+}
+
+bool PWM::setDeadTime(uint32_t lowSideNs, uint32_t highSideNs)
+{
+  if (!_tcc || !tccDeadTime[_tcNum]) {
+    return false;
+  }
+
+  uint32_t low = nsToDeadTime(lowSideNs);
+  uint32_t high = nsToDeadTime(highSideNs);
+  if (low > 0xFF || high > 0xFF) {
+    return false;
+  }
+
+  disableTCC(_tcc);
+  uint32_t wexctrl = _tcc->WEXCTRL.reg & ~(TCC_WEXCTRL_DTLS_Msk | TCC_WEXCTRL_DTHS_Msk);
+  _tcc->WEXCTRL.reg = wexctrl | TCC_WEXCTRL_DTLS(low) | TCC_WEXCTRL_DTHS(high);
+  enableTCC(_tcc);
+
+  return true;
+}
+
+void PWM::write(uint32_t pin, uint32_t value)
+{
+  uint8_t channel, output;
+
+  if (!pinChannel(pin, &channel, &output)) {
+    return;
+  }
+
+#if defined(__SAMD51__)
+  _tcc->CCBUF[channel].reg = value;
+#else
+  _tcc->CCB[channel].reg = value;
+#endif
+}
+
+void PWM::beginUpdate()
+{
+  if (_tcc) {
+    _tcc->CTRLBSET.reg = TCC_CTRLBSET_LUPD;
+    while (_tcc->SYNCBUSY.bit.CTRLB);
+  }
+}
+
+void PWM::endUpdate()
+{
+  if (_tcc) {
+    _tcc->CTRLBCLR.reg = TCC_CTRLBCLR_LUPD;
+    while (_tcc->SYNCBUSY.bit.CTRLB);
+  }
+}
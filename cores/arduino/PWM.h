@@ -0,0 +1,108 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+
+/*
+ * Direct control of one TCC instance for PWM output.
+ *
+ * The TCC is picked from the ulPWMChannel of the pin passed to the
+ * constructor; every pin attached afterwards must be driven by the same
+ * TCC. Frequency and period are per TCC, duty is per channel and is given
+ * in timer counts from 0 to period().
+ *
+ * A PWM object takes the whole TCC over: don't call analogWrite() on
+ * other pins driven by it, as that resets the timer to its defaults.
+ */
+class PWM
+{
+public:
+  PWM(uint32_t pin);
+
+  /*
+   * Starts the TCC at the requested frequency, choosing the smallest
+   * prescaler that fits the period in the counter, which gives the
+   * highest resolution. Center-aligned (dual slope) PWM halves the
+   * achievable resolution. Attaches the constructor pin. Returns false
+   * if that pin is out of range or not driven by a TCC.
+   */
+  bool begin(uint32_t frequency, bool centerAligned = false);
+  void end();
+
+  // Changes the frequency; duty counts are not rescaled
+  bool setFrequency(uint32_t frequency);
+
+  // Selects an exact period (the 100% duty count) and prescaler (1..1024)
+  bool setPeriod(uint32_t period, uint16_t prescaler = 1);
+
+  uint32_t frequency() const;
+  uint32_t period() const { return _period; }
+
+  // Routes another pin of the same TCC to its output
+  bool attach(uint32_t pin);
+
+  /*
+   * Drives pin and complementPin as a complementary pair through the
+   * dead-time insertion unit, so the two are never on together. The
+   * pins must be outputs WO[x] and WO[x + n/2] of the TCC, in that
+   * order, and only TCCs with a DTI unit support this (TCC0 on SAMD21,
+   * TCC0/TCC1 on SAMD51). Duty is then written through pin. Returns
+   * false if both are the same pin.
+   *
+   * The SAMD21 variant tables give both WO[x] and WO[x + 4] as channel
+   * x, so there only the channel is checked: pins on the same WO, or
+   * swapped, aren't detected and give the wrong pair or an inverted duty.
+   */
+  bool attachComplementary(uint32_t pin, uint32_t complementPin, uint32_t deadTimeNs);
+
+  /*
+   * Sets the dead time inserted before the low side and high side
+   * outputs turn on. The DTI counts GCLK_TCC cycles with 8 bits, so the
+   * maximum is about 5us on SAMD21 and 2us on SAMD51. Shared by all
+   * complementary pairs of the TCC.
+   */
+  bool setDeadTime(uint32_t lowSideNs, uint32_t highSideNs);
+
+  // Duty in counts, taking effect at the next period boundary
+  void write(uint32_t pin, uint32_t value);
+
+  /*
+   * Holds back all write() calls made between beginUpdate() and
+   * endUpdate(), then applies them at the same period boundary.
+   */
+  void beginUpdate();
+  void endUpdate();
+
+private:
+  bool configure(uint32_t period, uint8_t prescaler);
+  bool pinChannel(uint32_t pin, uint8_t *channel, uint8_t *output) const;
+  uint32_t nsToDeadTime(uint32_t ns) const;
+
+  Tcc *_tcc;
+  uint8_t _tcNum;
+  uint8_t _prescaler;
+  bool _centerAligned;
+  uint32_t _period;
+  uint32_t _pin;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PortBus.h"
+
+PortBus::PortBus(const uint8_t *pins, uint8_t width) :
+  _pins(pins),
+  _width(width),
+  _nibbles(0),
+  _contiguous(false),
+  _shift(0),
+  _port(NOT_A_PORT),
+  _mask(0),
+  _io(NULL)
+{
+}
+
+bool PortBus::begin(uint32_t mode)
+{
+  if (_width == 0 || _width > PORTBUS_MAX_WIDTH) {
+    return false;
+  }
+
+  _port = g_APinDescription[_pins[0]].ulPort;
+  _mask = 0;
+  _contiguous = true;
+
+  for (uint8_t i = 0; i < _width; i++) {
+    const PinDescription &pinDesc = g_APinDescription[_pins[i]];
+
+    if (pinDesc.ulPinType == PIO_NOT_A_PIN || pinDesc.ulPort != _port) {
+      return false;
+    }
+
+    _bit[i] = pinDesc.ulPin;
+    if (_mask & (1ul << _bit[i])) {
+      return false;
+    }
+    _mask |= 1ul << _bit[i];
+
+    if (_bit[i] != _bit[0] + i) {
+      _contiguous = false;
+    }
+  }
+
+  _shift = _bit[0];
+  _nibbles = (_width + 3) / 4;
+
+  if (!_contiguous) {
+    for (uint8_t n = 0; n < _nibbles; n++) {
+      for (uint8_t v = 0; v < 16; v++) {
+        uint32_t bits = 0;
+        for (uint8_t k = 0; k < 4; k++) {
+          uint8_t i = n * 4 + k;
+          if (i < _width && (v & (1 << k))) {
+            bits |= 1ul << _bit[i];
+          }
+        }
+        _lut[n][v] = bits;
+      }
+    }
+  }
+
+#if defined(PORT_IOBUS) && !defined(__SAMD51__)
+  // Single-cycle access for the data path, as in FastPin
+  _io = &PORT_IOBUS->Group[_port];
+#else
+  _io = &PORT->Group[_port];
+#endif
+
+  switch (mode) {
+    case INPUT:        input(false); break;
+    case INPUT_PULLUP: input(true);  break;
+    default:           output();     break;
+  }
+
+  return true;
+}
+
+void PortBus::configure(uint32_t pincfg)
+{
+  PortGroup *group = &PORT->Group[_port];
+  uint32_t lower = _mask & 0xFFFF;
+  uint32_t upper = _mask >> 16;
+
+  // WRCONFIG sets PINCFG for up to 16 pins of one half-port per write
+  if (lower) {
+    group->WRCONFIG.reg = PORT_WRCONFIG_WRPINCFG | pincfg | PORT_WRCONFIG_PINMASK(lower);
+  }
+  if (upper) {
+    group->WRCONFIG.reg = PORT_WRCONFIG_HWSEL | PORT_WRCONFIG_WRPINCFG | pincfg | PORT_WRCONFIG_PINMASK(upper);
+  }
+}
+
+void PortBus::output()
+{
+  // Input stays enabled so the bus can be read back
+  configure(PORT_WRCONFIG_INEN);
+  PORT->Group[_port].DIRSET.reg = _mask;
+  sampleContinuously();
+}
+
+void PortBus::input(bool pullup)
+{
+  configure(PORT_WRCONFIG_INEN | (pullup ? PORT_WRCONFIG_PULLEN : 0));
+  PORT->Group[_port].DIRCLR.reg = _mask;
+  if (pullup) {
+    PORT->Group[_port].OUTSET.reg = _mask;
+  }
+  sampleContinuously();
+}
+
+void PortBus::sampleContinuously()
+{
+#if defined(PORT_IOBUS) && !defined(__SAMD51__)
+  // IN can only be read over the IOBUS with continuous sampling enabled
+  PORT->Group[_port].CTRL.reg |= _mask;
+#endif
+}
+
+uint32_t PortBus::read() const
+{
+  uint32_t in = _io->IN.reg;
+
+  if (_contiguous) {
+    return (in & _mask) >> _shift;
+  }
+
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < _width; i++) {
+    value |= ((in >> _bit[i]) & 1) << i;
+  }
+  return value;
+}
+
+volatile void *PortBus::outAddress() const
+{
+  // DMA can't reach the IOBUS, so this is always the APB address
+  volatile uint8_t *out = (volatile uint8_t *)&PORT->Group[_port].OUT.reg;
+
+  if (!_contiguous) {
+    return NULL;
+  }
+  if (_width == 8 && (_shift % 8) == 0) {
+    return out + _shift / 8;
+  }
+  if (_width == 16 && (_shift % 16) == 0) {
+    return out + _shift / 8;
+  }
+  return NULL;
+}
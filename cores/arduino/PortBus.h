@@ -0,0 +1,96 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+
+#define PORTBUS_MAX_WIDTH 16
+
+/*
+ * Up to 16 pins of one PORT group, read and written as a single word.
+ *
+ * pins[0] is bit 0 of the bus value. When the pins sit on consecutive,
+ * ascending port bits a value is placed with one shift; otherwise it is
+ * spread through per-nibble lookup tables built by begin(). Either way
+ * write() is a single OUTTGL store touching only the bus pins, so other
+ * pins of the group may be driven from interrupts at the same time.
+ */
+class PortBus
+{
+public:
+  PortBus(const uint8_t *pins, uint8_t width);
+
+  // Returns false if the pins span more than one PORT group
+  bool begin(uint32_t mode = OUTPUT);
+
+  // Switches all pins at once with a WRCONFIG write per half-port
+  void output();
+  void input(bool pullup = false);
+
+  inline void write(uint32_t value)
+  {
+    uint32_t bits = encode(value);
+    _io->OUTTGL.reg = (_io->OUT.reg ^ bits) & _mask;
+  }
+
+  uint32_t read() const;
+
+  // Port bit pattern for value, e.g. to prepare a buffer for DMA
+  inline uint32_t encode(uint32_t value) const
+  {
+    if (_contiguous) {
+      return (value << _shift) & _mask;
+    }
+
+    uint32_t bits = 0;
+    for (uint8_t n = 0; n < _nibbles; n++, value >>= 4) {
+      bits |= _lut[n][value & 0xF];
+    }
+    return bits;
+  }
+
+  /*
+   * For an 8-bit bus on a byte-aligned run of port bits (or a 16-bit bus
+   * on bits 0-15 or 16-31), the byte or halfword of OUT the bus occupies.
+   * DMA can store raw bus values there directly, and a narrow store
+   * leaves the rest of the group untouched. NULL for any other layout.
+   */
+  volatile void *outAddress() const;
+
+  uint32_t mask() const { return _mask; }
+
+private:
+  void configure(uint32_t pincfg);
+  void sampleContinuously();
+
+  const uint8_t *_pins;
+  uint8_t _width;
+  uint8_t _nibbles;
+  bool _contiguous;
+  uint8_t _shift;
+  EPortType _port;
+  uint32_t _mask;
+  uint8_t _bit[PORTBUS_MAX_WIDTH];
+  uint32_t _lut[PORTBUS_MAX_WIDTH / 4][16];
+  PortGroup *_io;
+};
+
+#endif
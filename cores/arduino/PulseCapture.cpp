@@ -0,0 +1,186 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PulseCapture.h"
+#include "EventSystem.h"
+
+#if defined(__SAMD51__)
+#define WAIT_TC_SYNC(tc, mask)  while ((tc)->COUNT16.SYNCBUSY.reg & (mask))
+#define FIRST_TC_EVU            EVSYS_ID_USER_TC0_EVU
+#else
+#define WAIT_TC_SYNC(tc, mask)  while ((tc)->COUNT16.STATUS.bit.SYNCBUSY)
+#define FIRST_TC_EVU            EVSYS_ID_USER_TC3_EVU
+#endif
+
+static const uint16_t prescalers[] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+
+PulseCapture::PulseCapture(uint32_t pin, Tc *tc, uint32_t state) :
+  _pin(pin),
+  _tc(tc),
+  _state(state),
+  _tcNum(-1),
+  _channel(-1),
+  _prescaler(1),
+  _period(0),
+  _width(0),
+  _overflow(false)
+{
+}
+
+bool PulseCapture::begin(uint16_t prescaler)
+{
+  uint8_t div = 0xFF;
+  for (uint8_t i = 0; i < sizeof(prescalers) / sizeof(prescalers[0]); i++) {
+    if (prescalers[i] == prescaler) {
+      div = i;
+    }
+  }
+  if (div == 0xFF) {
+    return false;
+  }
+
+  _tcNum = -1;
+  for (uint8_t i = TCC_INST_NUM; i < TCC_INST_NUM + TC_INST_NUM; i++) {
+    if (g_apTCInstances[i] == _tc) {
+      _tcNum = i;
+    }
+  }
+  if (_tcNum < 0) {
+    return false;
+  }
+
+  // A level event: the TC sees the pulse itself, start and end
+  int generator = EventSystem.pinGenerator(_pin, _state == LOW ? LOW : HIGH);
+  if (generator < 0) {
+    return false;
+  }
+  _channel = EventSystem.connect(generator, FIRST_TC_EVU + (_tcNum - TCC_INST_NUM));
+  if (_channel < 0) {
+    detachInterruptEvent(_pin);
+    return false;
+  }
+
+  _prescaler = prescaler;
+
+#if defined(__SAMD51__)
+  GCLK->PCHCTRL[GCLK_CLKCTRL_IDs[_tcNum]].reg = GCLK_PCHCTRL_GEN_GCLK0_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+  while (GCLK->PCHCTRL[GCLK_CLKCTRL_IDs[_tcNum]].bit.CHEN == 0);
+#else
+  static const uint16_t GCLK_CLKCTRL_IDs[] = {
+    GCLK_CLKCTRL_ID(GCM_TCC2_TC3),  // TC3
+    GCLK_CLKCTRL_ID(GCM_TC4_TC5),   // TC4
+    GCLK_CLKCTRL_ID(GCM_TC4_TC5),   // TC5
+    GCLK_CLKCTRL_ID(GCM_TC6_TC7),   // TC6
+    GCLK_CLKCTRL_ID(GCM_TC6_TC7),   // TC7
+  };
+  GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_IDs[_tcNum - TCC_INST_NUM]);
+  while (GCLK->STATUS.bit.SYNCBUSY == 1);
+#endif
+
+  _tc->COUNT16.CTRLA.bit.ENABLE = 0;
+  WAIT_TC_SYNC(_tc, TC_SYNCBUSY_ENABLE);
+  _tc->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  WAIT_TC_SYNC(_tc, TC_SYNCBUSY_SWRST);
+
+  // PPW: period into CC0, pulse width into CC1
+#if defined(__SAMD51__)
+  _tc->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER(div) |
+                           TC_CTRLA_CAPTEN0 | TC_CTRLA_CAPTEN1;
+#else
+  _tc->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER(div);
+  _tc->COUNT16.CTRLC.reg = TC_CTRLC_CPTEN0 | TC_CTRLC_CPTEN1;
+  WAIT_TC_SYNC(_tc, 0);
+#endif
+  _tc->COUNT16.EVCTRL.reg = TC_EVCTRL_TCEI | TC_EVCTRL_EVACT_PPW;
+
+  _tc->COUNT16.CTRLA.bit.ENABLE = 1;
+  WAIT_TC_SYNC(_tc, TC_SYNCBUSY_ENABLE);
+
+  _period = 0;
+  _width = 0;
+  _overflow = false;
+  _tc->COUNT16.INTFLAG.reg = TC_INTFLAG_OVF;
+  return true;
+}
+
+void PulseCapture::end()
+{
+  if (_tcNum < 0) {
+    return;
+  }
+
+  _tc->COUNT16.CTRLA.bit.ENABLE = 0;
+  WAIT_TC_SYNC(_tc, TC_SYNCBUSY_ENABLE);
+  _tc->COUNT16.EVCTRL.reg = 0;
+
+  EventSystem.release(_channel);
+  _channel = -1;
+  detachInterruptEvent(_pin);
+  _tcNum = -1;
+}
+
+bool PulseCapture::available() const
+{
+  return _tcNum >= 0 && _tc->COUNT16.INTFLAG.bit.MC1;
+}
+
+bool PulseCapture::read()
+{
+  if (!available()) {
+    return false;
+  }
+
+  // Reading CCx clears MCx
+  _period = _tc->COUNT16.CC[0].reg;
+  _width = _tc->COUNT16.CC[1].reg;
+
+  _overflow = _tc->COUNT16.INTFLAG.bit.OVF;
+  _tc->COUNT16.INTFLAG.reg = TC_INTFLAG_OVF;
+  return true;
+}
+
+uint32_t PulseCapture::measure(uint32_t timeout)
+{
+  if (_tcNum < 0) {
+    return 0;
+  }
+
+  // Discard anything captured before the call, then wait for a pulse that
+  // starts (MC0) and ends (MC1) afterwards
+  _tc->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0 | TC_INTFLAG_MC1;
+
+  uint32_t start = micros();
+  while (!_tc->COUNT16.INTFLAG.bit.MC0) {
+    if (micros() - start > timeout) {
+      return 0;
+    }
+  }
+
+  // The counter restarted with the pulse, so from here on a wrap means the
+  // pulse is too long for the prescaler
+  _tc->COUNT16.INTFLAG.reg = TC_INTFLAG_OVF;
+
+  while (!_tc->COUNT16.INTFLAG.bit.MC1) {
+    if (micros() - start > timeout || _tc->COUNT16.INTFLAG.bit.OVF) {
+      return 0;
+    }
+  }
+
+  read();
+  return _overflow ? 0 : widthMicros();
+}
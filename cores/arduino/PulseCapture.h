@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+
+/*
+ * Measures period and pulse width of a signal in hardware, without
+ * blocking the CPU.
+ *
+ * The pin's external interrupt line is routed through the event system to
+ * a TC running in pulse-width-period (PPW) capture mode. At the start of
+ * each pulse the TC captures the period into CC0 and restarts; at the end
+ * of the pulse it captures the width into CC1. Both are counted in ticks
+ * of F_CPU / prescaler, in 16 bits, so the prescaler sets the range:
+ * at 48MHz, /8 gives 1/6us resolution up to 10.9ms, /64 covers RC servo
+ * frames (20ms) at 1.3us.
+ *
+ * Capture runs continuously once begun; available() and read() only poll
+ * the result registers. Each instance needs its own TC and EXTINT line,
+ * so several inputs can be measured at once.
+ *
+ * Example:
+ *   PulseCapture echo(A1, TC4);
+ *   echo.begin(64);
+ *   ...
+ *   if (echo.available()) {
+ *     float cm = echo.widthMicros() / 58.0;
+ *   }
+ */
+class PulseCapture
+{
+public:
+  // state is the level of the pulse to measure, HIGH or LOW
+  PulseCapture(uint32_t pin, Tc *tc, uint32_t state = HIGH);
+
+  // prescaler is one of 1, 2, 4, 8, 16, 64, 256, 1024. Returns false if the
+  // pin has no EXTINT line, the TC isn't one of the variant's, or no event
+  // channel is free.
+  bool begin(uint16_t prescaler = 8);
+  void end();
+
+  // A complete pulse has been captured since the last read()
+  bool available() const;
+
+  // Latches the last capture; false if there was none since the last call
+  bool read();
+
+  // The counter wrapped before the last read(): the period, or the width
+  // if the pulse itself was that long, exceeded 16 bits and is wrong
+  bool overflowed() const { return _overflow; }
+
+  // Results of the last read(), in timer ticks
+  uint16_t periodTicks() const { return _period; }
+  uint16_t widthTicks() const { return _width; }
+
+  // Results of the last read(), in microseconds
+  uint32_t periodMicros() const { return ticksToMicros(_period); }
+  uint32_t widthMicros() const { return ticksToMicros(_width); }
+
+  // Blocks until a pulse is captured or timeout (in microseconds) expires,
+  // like pulseIn(); returns the width in microseconds, or 0 on timeout or
+  // if the pulse is too long for the prescaler
+  uint32_t measure(uint32_t timeout = 1000000L);
+
+  uint32_t tickFrequency() const { return F_CPU / _prescaler; }
+  uint32_t ticksToMicros(uint32_t ticks) const { return (uint32_t)(((uint64_t)ticks * _prescaler) / (F_CPU / 1000000)); }
+
+private:
+  uint32_t _pin;
+  Tc *_tc;
+  uint32_t _state;
+  int8_t _tcNum;
+  int8_t _channel;
+  uint16_t _prescaler;
+  uint16_t _period;
+  uint16_t _width;
+  bool _overflow;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PwmPin.h"
+
+bool PwmPin::begin(uint32_t value)
+{
+  if (_pin >= PINS_COUNT) {
+    return false;
+  }
+
+  const PinDescription &pinDesc = g_APinDescription[_pin];
+  uint32_t attr = pinDesc.ulPinAttribute;
+
+#if defined(__SAMD51__)
+  if (!(attr & (PIN_ATTR_PWM_E|PIN_ATTR_PWM_F|PIN_ATTR_PWM_G))) {
+    return false;
+  }
+#else
+  if ((attr & PIN_ATTR_PWM) != PIN_ATTR_PWM) {
+    return false;
+  }
+#endif
+
+  // Let analogWrite() do the clock, mux and mode setup once
+  analogWrite(_pin, 0);
+
+  uint32_t tcNum = GetTCNumber(pinDesc.ulPWMChannel);
+  uint8_t tcChannel = GetTCChannelNumber(pinDesc.ulPWMChannel);
+  _tc = (void *)GetTC(pinDesc.ulPWMChannel);
+
+  if (tcNum < TCC_INST_NUM) {
+    Tcc *TCCx = (Tcc *)_tc;
+#if defined(__SAMD51__)
+    _cc = &TCCx->CCBUF[tcChannel].reg;
+#else
+    _cc = &TCCx->CCB[tcChannel].reg;
+#endif
+    _width = 4;
+  } else {
+    Tc *TCx = (Tc *)_tc;
+#if defined(__SAMD51__)
+    // analogWrite() runs TCs in 8-bit mode
+    _cc = &TCx->COUNT8.CCBUF[tcChannel].reg;
+    _width = 1;
+#else
+    _cc = &TCx->COUNT16.CC[tcChannel].reg;
+    _width = 2;
+#endif
+  }
+
+  write(value);
+  return true;
+}
+
+uint32_t PwmPin::top() const
+{
+  switch (_width) {
+    case 4: return ((Tcc *)_tc)->PER.reg & TCC_PER_PER_Msk;
+#if defined(__SAMD51__)
+    case 1: return ((Tc *)_tc)->COUNT8.PER.reg;
+#else
+    case 2: return 0xFFFF;
+#endif
+    default: return 0;
+  }
+}
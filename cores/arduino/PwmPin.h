@@ -0,0 +1,71 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+
+/*
+ * Handle for fast duty-cycle updates on a PWM pin.
+ *
+ * begin() sets the pin up exactly as analogWrite() would and remembers
+ * which compare register drives it. write() is then a single store to
+ * that register, with no clock, mode or synchronization handling.
+ *
+ * Duty values are raw timer counts, from 0 to top(), in begin() as well
+ * as in write(); not analogWriteResolution() units.
+ *
+ * On a TCC (and on a SAMD51 TC) the store goes to the buffered compare
+ * register, so the new duty takes effect at the next period boundary and
+ * never produces a glitch. A SAMD21 TC has no compare buffer and is
+ * updated immediately.
+ */
+class PwmPin
+{
+public:
+  PwmPin(uint32_t pin) : _pin(pin), _width(0), _cc(NULL), _tc(NULL) { }
+
+  // value is the initial duty, in timer counts like write(). Returns false
+  // if the pin has no timer output.
+  bool begin(uint32_t value = 0);
+
+  // value is in timer counts, from 0 to top()
+  inline void write(uint32_t value)
+  {
+    switch (_width) {
+      case 1: *(volatile uint8_t *)_cc = (uint8_t)value; break;
+      case 2: *(volatile uint16_t *)_cc = (uint16_t)value; break;
+      case 4: *(volatile uint32_t *)_cc = value; break;
+    }
+  }
+
+  // Count at which the output period wraps, i.e. the 100% duty value
+  uint32_t top() const;
+
+  uint32_t pin() const { return _pin; }
+
+private:
+  uint32_t _pin;
+  uint8_t _width;
+  volatile void *_cc;
+  void *_tc;
+};
+
+#endif
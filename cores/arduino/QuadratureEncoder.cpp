@@ -0,0 +1,352 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "QuadratureEncoder.h"
+#include "EventSystem.h"
+
+#define INPUT_A     0
+#define INPUT_B     1
+#define INPUT_INDEX 2
+#define INPUT_A_FALLING 3   // Second channel from A, SAMD21 only
+
+#if defined(__SAMD51__)
+#define COUNTER_BITS 16
+static const uint8_t eventUsers[] = {
+  EVSYS_ID_USER_PDEC_EVU_0, EVSYS_ID_USER_PDEC_EVU_1, EVSYS_ID_USER_PDEC_EVU_2
+};
+#else
+#define COUNTER_BITS ENCODER_TCC_BITS
+
+static QuadratureEncoder *indexedEncoder;
+
+static inline void syncTCC(Tcc *TCCx)
+{
+  while (TCCx->SYNCBUSY.reg);
+}
+
+static void startTCC(Tcc *tcc, uint32_t evctrl)
+{
+  tcc->CTRLA.bit.ENABLE = 0;
+  syncTCC(tcc);
+  tcc->CTRLA.reg = TCC_CTRLA_SWRST;
+  while (tcc->SYNCBUSY.bit.SWRST);
+
+  // Counting events replaces counting the clock
+  tcc->EVCTRL.reg = evctrl;
+
+  tcc->CTRLA.bit.ENABLE = 1;
+  syncTCC(tcc);
+}
+
+static void stopTCC(Tcc *tcc)
+{
+  tcc->CTRLA.bit.ENABLE = 0;
+  syncTCC(tcc);
+  tcc->EVCTRL.reg = 0;
+}
+
+static uint32_t readTCC(Tcc *tcc)
+{
+  tcc->CTRLBSET.reg = TCC_CTRLBSET_CMD_READSYNC;
+  while (tcc->SYNCBUSY.bit.CTRLB);
+  while (tcc->SYNCBUSY.bit.COUNT);
+  return tcc->COUNT.reg;
+}
+
+static void writeTCC(Tcc *tcc, uint32_t count)
+{
+  tcc->COUNT.reg = count;
+  while (tcc->SYNCBUSY.bit.COUNT);
+}
+#endif
+
+static inline int32_t signExtend(uint32_t count, uint8_t bits)
+{
+  return (int32_t)(count << (32 - bits)) >> (32 - bits);
+}
+
+QuadratureEncoder::QuadratureEncoder(uint32_t pinA, uint32_t pinB, uint32_t pinIndex) :
+  _begun(false),
+  _angularBits(COUNTER_BITS),
+  _last(0),
+  _lastFalling(0),
+  _position(0),
+  _revolutions(0)
+{
+  _pins[INPUT_A] = pinA;
+  _pins[INPUT_B] = pinB;
+  _pins[INPUT_INDEX] = pinIndex;
+  for (uint8_t i = 0; i < 4; i++) {
+    _channels[i] = -1;
+  }
+}
+
+bool QuadratureEncoder::connect(uint8_t channel, uint8_t input, uint8_t user, EventEdge edge)
+{
+  // The level of the pin is the event; the channel or the counter finds
+  // the edges in it
+  int generator = EventSystem.pinGenerator(_pins[input], HIGH);
+  if (generator < 0) {
+    return false;
+  }
+
+  if (edge != EVENT_EDGE_NONE) {
+    _channels[channel] = EventSystem.connect(generator, user, EVENT_PATH_RESYNCHRONIZED, edge);
+  } else {
+    _channels[channel] = EventSystem.connect(generator, user);
+  }
+  if (_channels[channel] < 0) {
+    if (channel == input) {
+      detachInterruptEvent(_pins[input]);
+    }
+    return false;
+  }
+  return true;
+}
+
+bool QuadratureEncoder::begin(uint16_t countsPerRevolution)
+{
+  bool indexed = _pins[INPUT_INDEX] != PIN_NOT_A_PIN;
+  uint8_t inputs = indexed ? 3 : 2;
+
+  if (_begun) {
+    end();
+  }
+
+  // Each input needs an EXTINT line of its own
+  for (uint8_t i = 0; i < inputs; i++) {
+    if (_pins[i] >= PINS_COUNT) {
+      return false;
+    }
+    for (uint8_t j = 0; j < i; j++) {
+      if (g_APinDescription[_pins[i]].ulExtInt == g_APinDescription[_pins[j]].ulExtInt) {
+        return false;
+      }
+    }
+  }
+
+#if defined(__SAMD51__)
+  _angularBits = COUNTER_BITS;
+  if (indexed) {
+    _angularBits = 9;
+    while (_angularBits < COUNTER_BITS && (1ul << _angularBits) < countsPerRevolution) {
+      _angularBits++;
+    }
+  }
+
+  for (uint8_t i = 0; i < inputs; i++) {
+    if (!connect(i, i, eventUsers[i], EVENT_EDGE_NONE)) {
+      disconnect();
+      return false;
+    }
+  }
+
+  GCLK->PCHCTRL[PDEC_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK0_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+  while (GCLK->PCHCTRL[PDEC_GCLK_ID].bit.CHEN == 0);
+  MCLK->APBCMASK.reg |= MCLK_APBCMASK_PDEC;
+
+  PDEC->CTRLA.bit.ENABLE = 0;
+  while (PDEC->SYNCBUSY.bit.ENABLE);
+  PDEC->CTRLA.reg = PDEC_CTRLA_SWRST;
+  while (PDEC->SYNCBUSY.bit.SWRST);
+
+  // The inputs come from events, not from the PDEC's own pins
+  PDEC->CTRLA.reg = PDEC_CTRLA_MODE_QDEC | PDEC_CTRLA_CONF_X4 | PDEC_CTRLA_ANGULAR(_angularBits - 9);
+  PDEC->EVCTRL.reg = PDEC_EVCTRL_EVEI((1 << inputs) - 1);
+
+  PDEC->CTRLA.bit.ENABLE = 1;
+  while (PDEC->SYNCBUSY.bit.ENABLE);
+  PDEC->CTRLBSET.reg = PDEC_CTRLBSET_CMD_START;
+  while (PDEC->SYNCBUSY.bit.CTRLB);
+#else
+  (void)countsPerRevolution;
+
+  // Both edges of A count, the rising ones on ENCODER_TCC and the falling
+  // ones on ENCODER_FALLING_TCC, in the direction set by the level of B.
+  // For the falling edges B is inverted, so A bouncing while B holds
+  // still counts back and forth instead of drifting.
+  if (!connect(INPUT_A, INPUT_A, ENCODER_TCC_EVU_COUNT, EVENT_EDGE_RISING) ||
+      !connect(INPUT_A_FALLING, INPUT_A, ENCODER_FALLING_TCC_EVU_COUNT, EVENT_EDGE_FALLING) ||
+      !connect(INPUT_B, INPUT_B, ENCODER_TCC_EVU_DIR, EVENT_EDGE_NONE) ||
+      !EventSystem.addUser(_channels[INPUT_B], ENCODER_FALLING_TCC_EVU_DIR)) {
+    disconnect();
+    return false;
+  }
+
+  GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(ENCODER_TCC_GCM));
+  while (GCLK->STATUS.bit.SYNCBUSY == 1);
+  GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(ENCODER_FALLING_TCC_GCM));
+  while (GCLK->STATUS.bit.SYNCBUSY == 1);
+
+  startTCC(ENCODER_TCC, TCC_EVCTRL_TCEI0 | TCC_EVCTRL_TCEI1 |
+                        TCC_EVCTRL_EVACT0_COUNTEV | TCC_EVCTRL_EVACT1_DIR);
+  startTCC(ENCODER_FALLING_TCC, TCC_EVCTRL_TCEI0 | TCC_EVCTRL_TCEI1 | TCC_EVCTRL_TCINV1 |
+                                TCC_EVCTRL_EVACT0_COUNTEV | TCC_EVCTRL_EVACT1_DIR);
+
+  if (indexed) {
+    indexedEncoder = this;
+    attachInterrupt(_pins[INPUT_INDEX], onIndex, RISING);
+  }
+#endif
+
+  _last = 0;
+  _lastFalling = 0;
+  _position = 0;
+  _revolutions = 0;
+  _begun = true;
+  return true;
+}
+
+void QuadratureEncoder::end()
+{
+  if (!_begun) {
+    return;
+  }
+
+#if defined(__SAMD51__)
+  PDEC->CTRLA.bit.ENABLE = 0;
+  while (PDEC->SYNCBUSY.bit.ENABLE);
+  PDEC->EVCTRL.reg = 0;
+#else
+  stopTCC(ENCODER_TCC);
+  stopTCC(ENCODER_FALLING_TCC);
+
+  if (indexedEncoder == this) {
+    detachInterrupt(_pins[INPUT_INDEX]);
+    indexedEncoder = NULL;
+  }
+#endif
+
+  disconnect();
+  _begun = false;
+}
+
+void QuadratureEncoder::disconnect()
+{
+  for (uint8_t i = 0; i < 4; i++) {
+    if (_channels[i] >= 0) {
+      EventSystem.release(_channels[i]);
+      if (i != INPUT_A_FALLING) {
+        detachInterruptEvent(_pins[i]);
+      }
+      _channels[i] = -1;
+    }
+  }
+}
+
+#if defined(__SAMD51__)
+uint32_t QuadratureEncoder::readCount() const
+{
+  PDEC->CTRLBSET.reg = PDEC_CTRLBSET_CMD_READSYNC;
+  while (PDEC->SYNCBUSY.bit.CTRLB);
+  while (PDEC->SYNCBUSY.bit.COUNT);
+  return PDEC->COUNT.reg;
+}
+#else
+// The counts since the counters were last zeroed
+static int32_t readCounters()
+{
+  return signExtend(readTCC(ENCODER_TCC), ENCODER_TCC_BITS) +
+         signExtend(readTCC(ENCODER_FALLING_TCC), ENCODER_FALLING_TCC_BITS);
+}
+#endif
+
+int32_t QuadratureEncoder::read()
+{
+  if (!_begun) {
+    return 0;
+  }
+
+#if defined(__SAMD51__)
+  uint32_t count = readCount();
+
+  if (_pins[INPUT_INDEX] != PIN_NOT_A_PIN) {
+    return count & ((1ul << _angularBits) - 1);
+  }
+
+  // Add the signed change since the last read, modulo the counter width
+  _position += signExtend(count - _last, COUNTER_BITS);
+  _last = count;
+#else
+  if (_pins[INPUT_INDEX] != PIN_NOT_A_PIN) {
+    return readCounters();
+  }
+
+  uint32_t rising = readTCC(ENCODER_TCC);
+  uint32_t falling = readTCC(ENCODER_FALLING_TCC);
+
+  // Add the signed changes since the last read, modulo the counter widths
+  _position += signExtend(rising - _last, ENCODER_TCC_BITS) +
+               signExtend(falling - _lastFalling, ENCODER_FALLING_TCC_BITS);
+  _last = rising;
+  _lastFalling = falling;
+#endif
+  return _position;
+}
+
+void QuadratureEncoder::write(int32_t position)
+{
+  if (!_begun) {
+    return;
+  }
+
+  uint32_t count = (uint32_t)position & ((1ul << COUNTER_BITS) - 1);
+
+#if defined(__SAMD51__)
+  PDEC->COUNT.reg = count;
+  while (PDEC->SYNCBUSY.bit.COUNT);
+#else
+  writeTCC(ENCODER_TCC, count);
+  writeTCC(ENCODER_FALLING_TCC, 0);
+  _lastFalling = 0;
+#endif
+
+  _last = count;
+  _position = position;
+}
+
+int32_t QuadratureEncoder::revolutions()
+{
+#if defined(__SAMD51__)
+  uint8_t revolutionBits = COUNTER_BITS - _angularBits;
+  if (!_begun || revolutionBits == 0) {
+    return 0;
+  }
+
+  uint32_t count = readCount() >> _angularBits;
+  return signExtend(count, revolutionBits);
+#else
+  return _revolutions;
+#endif
+}
+
+#if !defined(__SAMD51__)
+void QuadratureEncoder::onIndex()
+{
+  QuadratureEncoder *encoder = indexedEncoder;
+  if (!encoder) {
+    return;
+  }
+
+  // The count since the last index pulse tells the way round
+  encoder->_revolutions += readCounters() >= 0 ? 1 : -1;
+
+  writeTCC(ENCODER_TCC, 0);
+  writeTCC(ENCODER_FALLING_TCC, 0);
+}
+#endif
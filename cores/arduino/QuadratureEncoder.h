@@ -0,0 +1,116 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+#include "EventSystem.h"
+
+/*
+ * The SAMD21 counters: TCCs, so the direction can come from an event, one
+ * for each edge of A. Their PWM pins can't be used with analogWrite()
+ * while the encoder runs.
+ */
+#if !defined(__SAMD51__) && !defined(ENCODER_TCC)
+#define ENCODER_TCC               TCC1
+#define ENCODER_TCC_GCM           GCM_TCC0_TCC1
+#define ENCODER_TCC_EVU_COUNT     EVSYS_ID_USER_TCC1_EV_0
+#define ENCODER_TCC_EVU_DIR       EVSYS_ID_USER_TCC1_EV_1
+#define ENCODER_TCC_BITS          24
+#endif
+
+#if !defined(__SAMD51__) && !defined(ENCODER_FALLING_TCC)
+#define ENCODER_FALLING_TCC           TCC2
+#define ENCODER_FALLING_TCC_GCM       GCM_TCC2_TC3
+#define ENCODER_FALLING_TCC_EVU_COUNT EVSYS_ID_USER_TCC2_EV_0
+#define ENCODER_FALLING_TCC_EVU_DIR   EVSYS_ID_USER_TCC2_EV_1
+#define ENCODER_FALLING_TCC_BITS      16
+#endif
+
+/*
+ * Counts the steps of a quadrature encoder in hardware, so no edge is lost
+ * to interrupt latency and reading the position doesn't stop the count.
+ *
+ * The A, B and index pins are routed from their EXTINT lines through the
+ * event system, so any pins with distinct EXTINT lines will do.
+ *
+ * On SAMD51 the PDEC decodes all four edges of each cycle (x4). With an
+ * index pin the PDEC splits its counter: the low bits count the position
+ * since the last index pulse, the high bits the revolutions.
+ *
+ * The SAMD21 has no quadrature decoder. Two TCCs count the rising and
+ * the falling edges of A, up or down as set by the level of B, which is two
+ * counts per cycle (x2). Counting both edges keeps the position from
+ * drifting when A chatters at an edge. An index pulse is handled by an
+ * interrupt, once per revolution.
+ *
+ * There is one decoder per chip, so only one instance can be begun.
+ *
+ * Example:
+ *   QuadratureEncoder knob(2, 3);
+ *   knob.begin();
+ *   ...
+ *   int32_t position = knob.read();
+ */
+class QuadratureEncoder
+{
+public:
+  QuadratureEncoder(uint32_t pinA, uint32_t pinB, uint32_t pinIndex = PIN_NOT_A_PIN);
+
+  /*
+   * With an index pin on SAMD51, countsPerRevolution sizes the position
+   * part of the counter (9 to 16 bits); the remaining bits count
+   * revolutions. Returns false if a pin is out of range or has no
+   * EXTINT line, two share one, or no event channel is free.
+   */
+  bool begin(uint16_t countsPerRevolution = 0);
+  void end();
+
+  /*
+   * The position in counts. Without an index the hardware counters are
+   * extended to 32 bits here, so it must be read at least once per 32767
+   * counts. With an index, the counts since the last index pulse.
+   */
+  int32_t read();
+  void write(int32_t position);
+
+  // Index pulses passed, negative when turning backwards
+  int32_t revolutions();
+
+private:
+  bool connect(uint8_t channel, uint8_t input, uint8_t user, EventEdge edge);
+  void disconnect();
+#if defined(__SAMD51__)
+  uint32_t readCount() const;
+#else
+  static void onIndex();
+#endif
+
+  uint32_t _pins[3];
+  int8_t _channels[4];
+  bool _begun;
+  uint8_t _angularBits;
+  uint32_t _last;
+  uint32_t _lastFalling;
+  int32_t _position;
+  volatile int32_t _revolutions;
+};
+
+#endif
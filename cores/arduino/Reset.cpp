@@ -102,10 +102,15 @@ reset:
 static int ticks = -1;
 
 void initiateReset(int _ticks) {
+	// The countdown runs from SysTick, which may otherwise be silent
+	if (ticks == -1)
+		tickRequest();
 	ticks = _ticks;
 }
 
 void cancelReset() {
+	if (ticks != -1)
+		tickRelease();
 	ticks = -1;
 }
 
@@ -679,6 +679,17 @@ bool SERCOM::isAddressMatch( void )
   return sercom->I2CS.INTFLAG.bit.AMATCH;
 }
 
+void SERCOM::enableAddressMatchInterruptWIRE( void )
+{
+  sercom->I2CS.INTENSET.reg = SERCOM_I2CS_INTENSET_AMATCH;
+}
+
+// While AMATCH stays set the slave holds SCL low, stretching the clock
+void SERCOM::disableAddressMatchInterruptWIRE( void )
+{
+  sercom->I2CS.INTENCLR.reg = SERCOM_I2CS_INTENCLR_AMATCH;
+}
+
 bool SERCOM::isMasterReadOperationWIRE( void )
 {
   return sercom->I2CS.STATUS.bit.DIR;
@@ -831,7 +842,7 @@ void SERCOM::initClockNVIC( void )
 
   for(uint8_t i=0; i<4; i++) {
     NVIC_ClearPendingIRQ(sercomData[idx].irq[i]);
-    NVIC_SetPriority(sercomData[idx].irq[i], SERCOM_NVIC_PRIORITY);
+    irqAssignPriority(sercomData[idx].irq[i], IRQ_CLASS_SERCOM);
     NVIC_EnableIRQ(sercomData[idx].irq[i]);
   }
 
@@ -850,7 +861,7 @@ void SERCOM::initClockNVIC( void )
 
   // Setting NVIC
   NVIC_ClearPendingIRQ(IdNvic);
-  NVIC_SetPriority(IdNvic, SERCOM_NVIC_PRIORITY);
+  irqAssignPriority(IdNvic, IRQ_CLASS_SERCOM);
   NVIC_EnableIRQ(IdNvic);
 
   // Setting clock
@@ -20,6 +20,7 @@
 #define _SERCOM_CLASS_
 
 #include "sam.h"
+#include "IrqPriority.h"
 
 // SAMD51 has configurable MAX_SPI, else use peripheral clock default.
 // Update: changing MAX_SPI via compiler flags is DEPRECATED, because
@@ -33,7 +34,7 @@
 #endif
 // Other SERCOM peripherals always use the 48 MHz clock
 #define SERCOM_FREQ_REF       48000000ul
-#define SERCOM_NVIC_PRIORITY  ((1<<__NVIC_PRIO_BITS) - 1)
+#define SERCOM_NVIC_PRIORITY  irqPriority(IRQ_CLASS_SERCOM)
 
 typedef enum
 {
@@ -232,6 +233,8 @@ class SERCOM
 		bool isStopDetectedWIRE( void ) ;
 		bool isRestartDetectedWIRE( void ) ;
 		bool isAddressMatch( void ) ;
+		void enableAddressMatchInterruptWIRE( void ) ;
+		void disableAddressMatchInterruptWIRE( void ) ;
 		bool isMasterReadOperationWIRE( void ) ;
     bool isRXNackReceivedWIRE( void ) ;
 		int availableWIRE( void ) ;
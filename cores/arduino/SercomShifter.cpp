@@ -0,0 +1,98 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "SercomShifter.h"
+#include "wiring_private.h"
+
+SercomShifter::SercomShifter(SERCOM *sercom, uint32_t dataOutPin, uint32_t clockPin, uint32_t dataInPin,
+                             SercomSpiTXPad txPad, SercomRXPad rxPad, uint32_t latchPin) :
+  _sercom(sercom),
+  _dataOutPin(dataOutPin),
+  _clockPin(clockPin),
+  _dataInPin(dataInPin),
+  _latchPin(latchPin),
+  _txPad(txPad),
+  _rxPad(rxPad)
+{
+}
+
+void SercomShifter::begin(uint32_t clockHz, uint32_t bitOrder)
+{
+  if (_dataOutPin != PIN_NOT_A_PIN) {
+    pinPeripheral(_dataOutPin, g_APinDescription[_dataOutPin].ulPinType);
+  }
+  if (_dataInPin != PIN_NOT_A_PIN) {
+    pinPeripheral(_dataInPin, g_APinDescription[_dataInPin].ulPinType);
+  }
+  pinPeripheral(_clockPin, g_APinDescription[_clockPin].ulPinType);
+
+  if (_latchPin != PIN_NOT_A_PIN) {
+    pinMode(_latchPin, OUTPUT);
+    digitalWrite(_latchPin, LOW);
+  }
+
+  // Both parts clock data in on the rising edge: SPI mode 0
+  _sercom->disableSPI();
+  _sercom->initSPI(_txPad, _rxPad, SPI_CHAR_SIZE_8_BITS, bitOrder == LSBFIRST ? LSB_FIRST : MSB_FIRST);
+  _sercom->initSPIClock(SERCOM_SPI_MODE_0, clockHz);
+  _sercom->enableSPI();
+}
+
+void SercomShifter::end()
+{
+  _sercom->resetSPI();
+}
+
+void SercomShifter::pulseLatch(uint32_t level)
+{
+  if (_latchPin == PIN_NOT_A_PIN) {
+    return;
+  }
+
+  digitalWrite(_latchPin, level);
+  digitalWrite(_latchPin, !level);
+}
+
+void SercomShifter::write(const uint8_t *data, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    _sercom->transferDataSPI(data[i]);
+  }
+  // The 595 copies the chain to its outputs on the rising edge of RCLK
+  pulseLatch(HIGH);
+}
+
+void SercomShifter::read(uint8_t *data, size_t count)
+{
+  // The 165 loads its parallel inputs while PL is low
+  pulseLatch(LOW);
+
+  for (size_t i = 0; i < count; i++) {
+    data[i] = _sercom->transferDataSPI(0xFF);
+  }
+}
+
+void SercomShifter::transfer(const uint8_t *out, uint8_t *in, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    uint8_t value = _sercom->transferDataSPI(out ? out[i] : 0xFF);
+    if (in) {
+      in[i] = value;
+    }
+  }
+}
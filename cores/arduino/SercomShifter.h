@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include "Arduino.h"
+#include "SERCOM.h"
+
+/*
+ * Drives a chain of shift registers (74HC595 outputs, 74HC165 inputs)
+ * from an otherwise unused SERCOM in SPI master mode, at up to several
+ * MHz and for any number of bytes.
+ *
+ * The pins must be the SERCOM's pads, with the same pad layout the SPI
+ * library takes (txPad selects data out and clock, rxPad data in). Pass
+ * PIN_NOT_A_PIN for a direction that isn't wired up.
+ *
+ * The optional latch pin is pulsed high after write() to transfer the
+ * shifted bits to the 595 outputs, and pulsed low before read() to load
+ * the 165 inputs into the chain.
+ */
+class SercomShifter
+{
+public:
+  SercomShifter(SERCOM *sercom, uint32_t dataOutPin, uint32_t clockPin, uint32_t dataInPin,
+                SercomSpiTXPad txPad, SercomRXPad rxPad, uint32_t latchPin = PIN_NOT_A_PIN);
+
+  void begin(uint32_t clockHz = 8000000, uint32_t bitOrder = MSBFIRST);
+  void end();
+
+  // Shifts count bytes out, data[0] first, then latches them
+  void write(const uint8_t *data, size_t count);
+
+  // Loads the inputs, then shifts count bytes in
+  void read(uint8_t *data, size_t count);
+
+  // Shifts out and in at the same time, without touching the latch
+  void transfer(const uint8_t *out, uint8_t *in, size_t count);
+
+private:
+  void pulseLatch(uint32_t level);
+
+  SERCOM *_sercom;
+  uint32_t _dataOutPin;
+  uint32_t _clockPin;
+  uint32_t _dataInPin;
+  uint32_t _latchPin;
+  SercomSpiTXPad _txPad;
+  SercomRXPad _rxPad;
+};
+
+#endif
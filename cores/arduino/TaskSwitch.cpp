@@ -0,0 +1,141 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "TaskSwitch.h"
+
+// Thread mode on PSP, basic frame
+#define EXC_RETURN_THREAD_PSP 0xFFFFFFFD
+
+#define INITIAL_XPSR          0x01000000  // Thumb state
+
+// The first fields are accessed by taskSwitchRun in task_switch.S
+struct TaskControl {
+  uint32_t sp;
+  uint32_t excReturn;
+  uint32_t regs[8];           // r4-r11
+#if defined(__ARM_FP)
+  uint32_t fpRegs[16];        // s16-s31
+#endif
+  TaskControl *next;
+  TaskScheduler::LoopArg loop;
+  void *arg;
+};
+
+extern "C" {
+  // Defined in task_switch.S
+  extern struct {
+    TaskControl *current;
+    TaskControl *next;
+  } taskSwitch;
+}
+
+TaskScheduler Tasks;
+
+// The task running loop(), on the main stack. Its context is only filled
+// in when it is first switched out.
+static TaskControl mainTask;
+static uint32_t taskCount = 1;
+
+static void callNoArg(void *arg)
+{
+  ((TaskScheduler::Loop)arg)();
+}
+
+static void taskEntry(TaskControl *task)
+{
+  for (;;) {
+    task->loop(task->arg);
+    yield();
+  }
+}
+
+bool TaskScheduler::startLoop(Loop loop, size_t stackSize)
+{
+  return startLoop(callNoArg, (void *)loop, stackSize);
+}
+
+bool TaskScheduler::startLoop(LoopArg loop, void *arg, size_t stackSize)
+{
+  // The stack follows its TaskControl in the same allocation
+  uint8_t *block = (uint8_t *)malloc(sizeof(TaskControl) + stackSize + 8);
+  if (block == NULL) {
+    return false;
+  }
+
+  TaskControl *task = (TaskControl *)block;
+  memset(task, 0, sizeof(TaskControl));
+  task->loop = loop;
+  task->arg = arg;
+
+  // An exception frame as if the task had been interrupted at taskEntry(task);
+  // the stack must be 8-byte aligned at exception return
+  uint32_t *frame = (uint32_t *)(((uintptr_t)block + sizeof(TaskControl) + stackSize + 8) & ~7ul) - 8;
+  frame[0] = (uint32_t)task;                 // r0
+  frame[1] = 0;                              // r1
+  frame[2] = 0;                              // r2
+  frame[3] = 0;                              // r3
+  frame[4] = 0;                              // r12
+  frame[5] = 0;                              // lr: taskEntry never returns
+  frame[6] = (uint32_t)taskEntry & ~1ul;     // pc
+  frame[7] = INITIAL_XPSR;
+
+  task->sp = (uint32_t)frame;
+  task->excReturn = EXC_RETURN_THREAD_PSP;
+
+  __disable_irq();
+  if (taskSwitch.current == NULL) {
+    // First task: the ring so far is just loop()'s
+    mainTask.next = &mainTask;
+    taskSwitch.current = &mainTask;
+    taskSwitch.next = &mainTask;
+  }
+
+  // Gets the next turn
+  task->next = taskSwitch.current->next;
+  taskSwitch.current->next = task;
+  taskCount++;
+  __enable_irq();
+
+  return true;
+}
+
+uint32_t TaskScheduler::count() const
+{
+  return taskCount;
+}
+
+extern "C" void taskYield(void)
+{
+  TaskControl *current = taskSwitch.current;
+
+  // Only thread mode code can be switched
+  if (current == NULL || __get_IPSR() != 0) {
+    return;
+  }
+
+  TaskControl *next = current->next;
+  if (next == current) {
+    return;
+  }
+
+  taskSwitch.next = next;
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  __DSB();
+  __ISB();
+}
@@ -0,0 +1,92 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Switches to the next task, if other tasks were started; does nothing in
+ * an interrupt handler. The default yield() calls it, so delay(), Stream
+ * timeouts, Uart::write() and SPI.waitForTransfer() all let the other
+ * tasks run while they wait.
+ *
+ * yield() refers to it weakly: the scheduler, and its PendSV handler, are
+ * only linked in when a sketch starts a task.
+ */
+void taskYield(void);
+
+#ifdef __cplusplus
+}
+
+#ifndef TASK_DEFAULT_STACK
+#define TASK_DEFAULT_STACK 1024
+#endif
+
+/*
+ * Cooperative multitasking: each task has a stack of its own and runs a
+ * loop function over and over, like loop(). A task keeps the CPU until it
+ * calls yield() (or something that does, such as delay()), so no locking
+ * is needed between tasks; interrupt handlers still preempt them as usual.
+ *
+ * The switch itself happens in PendSV, at the lowest interrupt priority.
+ * On the M4F, floating point registers are saved only for tasks that used
+ * the FPU, with the hardware's lazy stacking for s0-s15.
+ *
+ * Tasks run forever once started. Their stacks come from the heap; interrupt
+ * handlers use the main stack, so stackSize only has to cover the task's own
+ * calls. In the TICKLESS build delay() sleeps until the next interrupt
+ * between turns, so there the other tasks should wait with delay() as well.
+ *
+ * Not included by Arduino.h, so Tasks and the class name stay free for
+ * libraries; yield() works without it.
+ *
+ * Example:
+ *   #include <TaskSwitch.h>
+ *   ...
+ *   void blink() {
+ *     digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+ *     delay(500);
+ *   }
+ *   ...
+ *   Tasks.startLoop(blink);
+ */
+class TaskScheduler
+{
+public:
+  typedef void (*Loop)(void);
+  typedef void (*LoopArg)(void *arg);
+
+  // Returns false if the stack can't be allocated
+  bool startLoop(Loop loop, size_t stackSize = TASK_DEFAULT_STACK);
+  bool startLoop(LoopArg loop, void *arg, size_t stackSize = TASK_DEFAULT_STACK);
+
+  void yield() { taskYield(); }
+
+  // Number of tasks, including the one running loop()
+  uint32_t count() const;
+};
+
+extern TaskScheduler Tasks;
+
+#endif
@@ -0,0 +1,323 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "TimerWheel.h"
+
+/*
+ * Four levels of 64 slots. Level 0 holds the timers due in the next 64
+ * ticks, one slot per tick; each further level holds 64 times longer
+ * delays, one slot per 64 slots of the level below, and is moved down
+ * ("cascaded") one slot at a time as the lower level wraps. Timers due
+ * beyond the wheel's span wait in the last level and are placed again
+ * each time their slot cascades.
+ */
+#define WHEEL_BITS   6
+#define WHEEL_SLOTS  (1ul << WHEEL_BITS)
+#define WHEEL_MASK   (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_SPAN   (1ul << (WHEEL_BITS * WHEEL_LEVELS))
+
+#define STATE_USED      0x01
+#define STATE_ARMED     0x02  // In the wheel
+#define STATE_DUE       0x04  // Waiting for timerRunDeferred()
+#define STATE_CANCELLED 0x08
+
+static Timer *wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint32_t wheelNow;       // The next tick to be processed
+static uint32_t wheelArmed;     // Timers that will still fire
+
+static Timer pool[TIMER_POOL_SIZE];
+static Timer *freeList;
+static uint32_t freeCount;
+static bool poolReady;
+
+static Timer *dueHead;
+static Timer **dueTail = &dueHead;
+
+// Interrupts are disabled around every change to the wheel and lists,
+// which the SysTick handler, loop() and other handlers all make
+static inline uint32_t enterCritical()
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+
+static inline void exitCritical(uint32_t primask)
+{
+  __set_PRIMASK(primask);
+}
+
+void Timer::callNoArg(void *arg)
+{
+  ((Callback)arg)();
+}
+
+Timer *Timer::every(uint32_t ms, Callback cb, TimerMode mode)
+{
+  return start(ms, ms, callNoArg, (void *)cb, mode);
+}
+
+Timer *Timer::every(uint32_t ms, CallbackArg cb, void *arg, TimerMode mode)
+{
+  return start(ms, ms, cb, arg, mode);
+}
+
+Timer *Timer::after(uint32_t us, Callback cb, TimerMode mode)
+{
+  return after(us, callNoArg, (void *)cb, mode);
+}
+
+Timer *Timer::after(uint32_t us, CallbackArg cb, void *arg, TimerMode mode)
+{
+  // The current millisecond is partly gone, so one more tick is needed
+  // to wait at least us
+  return start(us / 1000 + (us % 1000 ? 1 : 0) + 1, 0, cb, arg, mode);
+}
+
+Timer *Timer::start(uint32_t ticks, uint32_t period, CallbackArg cb, void *arg, TimerMode mode)
+{
+  if (cb == NULL) {
+    return NULL;
+  }
+  if (ticks == 0) {
+    ticks = 1;
+  }
+
+  uint32_t primask = enterCritical();
+
+  if (!poolReady) {
+    for (uint32_t i = 0; i < TIMER_POOL_SIZE; i++) {
+      pool[i]._next = freeList;
+      freeList = &pool[i];
+    }
+    freeCount = TIMER_POOL_SIZE;
+    poolReady = true;
+  }
+
+  Timer *t = freeList;
+  if (t == NULL) {
+    exitCritical(primask);
+    return NULL;
+  }
+  freeList = t->_next;
+  freeCount--;
+
+  t->_callback = cb;
+  t->_arg = arg;
+  t->_period = period;
+  t->_mode = mode;
+  t->_state = STATE_USED;
+  t->_expires = wheelNow + ticks - 1;
+  t->link();
+
+  if (wheelArmed++ == 0) {
+    tickRequest();
+  }
+
+  exitCritical(primask);
+  return t;
+}
+
+void Timer::link()
+{
+  int32_t delta = (int32_t)(_expires - wheelNow);
+
+  if (delta < 0) {
+    delta = 0;
+  } else if ((uint32_t)delta >= WHEEL_SPAN) {
+    delta = WHEEL_SPAN - 1;
+  }
+
+  uint32_t level = 0;
+  while (level < WHEEL_LEVELS - 1 && (uint32_t)delta >= (WHEEL_SLOTS << (WHEEL_BITS * level))) {
+    level++;
+  }
+
+  Timer **slot = &wheel[level][((wheelNow + delta) >> (WHEEL_BITS * level)) & WHEEL_MASK];
+
+  _next = *slot;
+  if (_next) {
+    _next->_pprev = &_next;
+  }
+  _pprev = slot;
+  *slot = this;
+  _state |= STATE_ARMED;
+}
+
+void Timer::unlink()
+{
+  *_pprev = _next;
+  if (_next) {
+    _next->_pprev = _pprev;
+  }
+  _state &= ~STATE_ARMED;
+}
+
+void Timer::release()
+{
+  _state = 0;
+  _next = freeList;
+  freeList = this;
+  freeCount++;
+}
+
+void Timer::cancel()
+{
+  uint32_t primask = enterCritical();
+
+  if ((_state & STATE_USED) && !(_state & STATE_CANCELLED)) {
+    if (_state & STATE_ARMED) {
+      unlink();
+      if (--wheelArmed == 0) {
+        tickRelease();
+      }
+    }
+    if (_state & STATE_DUE) {
+      // Still in the deferred list: timerRunDeferred() frees it
+      _state |= STATE_CANCELLED;
+    } else {
+      release();
+    }
+  }
+
+  exitCritical(primask);
+}
+
+bool Timer::active() const
+{
+  uint8_t state = _state;
+  return (state & STATE_USED) && !(state & STATE_CANCELLED) && (state & (STATE_ARMED | STATE_DUE));
+}
+
+uint32_t Timer::available()
+{
+  return poolReady ? freeCount : TIMER_POOL_SIZE;
+}
+
+// Called with interrupts disabled, for a timer just taken off the wheel
+void Timer::expire()
+{
+  if (_period) {
+    _expires += _period;
+    link();
+  } else if (--wheelArmed == 0) {
+    tickRelease();
+  }
+
+  if (_mode == TIMER_ISR) {
+    CallbackArg cb = _callback;
+    void *arg = _arg;
+
+    if (!_period) {
+      release();
+    }
+    __enable_irq();
+    cb(arg);
+    __disable_irq();
+  } else if (!(_state & STATE_DUE)) {
+    // A periodic timer still waiting from its last expiry isn't queued twice
+    _state |= STATE_DUE;
+    _nextDeferred = NULL;
+    *dueTail = this;
+    dueTail = &_nextDeferred;
+  }
+}
+
+extern "C" void timerTick(void)
+{
+  uint32_t primask = enterCritical();
+
+  if (wheelArmed == 0) {
+    wheelNow++;
+    exitCritical(primask);
+    return;
+  }
+
+  uint32_t tick = wheelNow;
+  uint32_t index = tick & WHEEL_MASK;
+
+  // Bring down the timers of the next span of each level that wrapped
+  for (uint32_t level = 1; level < WHEEL_LEVELS && index == 0; level++) {
+    index = (tick >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+    Timer *t = wheel[level][index];
+    wheel[level][index] = NULL;
+    while (t) {
+      Timer *next = t->_next;
+      t->link();
+      t = next;
+    }
+  }
+
+  // Take the due timers off their slot so periodic ones can be put back
+  Timer *due = wheel[0][tick & WHEEL_MASK];
+  if (due) {
+    due->_pprev = &due;
+  }
+  wheel[0][tick & WHEEL_MASK] = NULL;
+  wheelNow = tick + 1;
+
+  while (due) {
+    Timer *t = due;
+    t->unlink();
+    t->expire();
+  }
+
+  exitCritical(primask);
+}
+
+extern "C" void timerRunDeferred(void)
+{
+  static bool running = false;
+
+  // A callback calling delay() doesn't run the others inside it
+  if (running) {
+    return;
+  }
+  running = true;
+
+  uint32_t primask = enterCritical();
+  Timer *t = dueHead;
+  dueHead = NULL;
+  dueTail = &dueHead;
+  exitCritical(primask);
+
+  // Only the timers due so far, so a slow callback can't keep this going
+  while (t) {
+    primask = enterCritical();
+    Timer *next = t->_nextDeferred;
+    uint8_t state = t->_state;
+    Timer::CallbackArg cb = t->_callback;
+    void *arg = t->_arg;
+
+    t->_state &= ~STATE_DUE;
+    if ((state & STATE_CANCELLED) || !(state & STATE_ARMED)) {
+      t->release();
+    }
+    exitCritical(primask);
+
+    if (!(state & STATE_CANCELLED)) {
+      cb(arg);
+    }
+    t = next;
+  }
+
+  running = false;
+}
@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Advances the timer wheel by one millisecond; called from SysTick
+void timerTick(void);
+
+// Runs the callbacks of expired deferred timers; called after each loop()
+// and while delay() waits
+void timerRunDeferred(void);
+
+#ifdef __cplusplus
+}
+
+// Number of timers that can be armed at once; may be set from variant.h
+#ifndef TIMER_POOL_SIZE
+#define TIMER_POOL_SIZE 16
+#endif
+
+enum TimerMode {
+  // The callback runs from timerRunDeferred(), in the context of loop()
+  TIMER_DEFERRED = 0,
+  // The callback runs in the SysTick interrupt; it must be short
+  TIMER_ISR = 1,
+};
+
+/*
+ * Software timers, with millisecond resolution, kept in a hierarchical
+ * timing wheel that SysTick advances once per millisecond. Arming and
+ * cancelling a timer take constant time, and each tick only looks at the
+ * timers due in that millisecond, however many are armed.
+ *
+ * Timers come from a static pool of TIMER_POOL_SIZE; every() and after()
+ * return NULL when it is exhausted. A one-shot timer returns to the pool
+ * once its callback has run, after which its pointer must not be used.
+ *
+ * Not included by Arduino.h, so the class name stays free for libraries.
+ *
+ * Example:
+ *   #include <TimerWheel.h>
+ *   ...
+ *   void blink() { digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN)); }
+ *   ...
+ *   Timer *t = Timer::every(500, blink);
+ *   ...
+ *   t->cancel();
+ */
+class Timer
+{
+public:
+  typedef void (*Callback)(void);
+  typedef void (*CallbackArg)(void *arg);
+
+  // Calls cb every ms milliseconds, the first time ms milliseconds from now
+  static Timer *every(uint32_t ms, Callback cb, TimerMode mode = TIMER_DEFERRED);
+  static Timer *every(uint32_t ms, CallbackArg cb, void *arg, TimerMode mode = TIMER_DEFERRED);
+
+  // Calls cb once, no sooner than us microseconds from now. The wheel
+  // ticks each millisecond, so this is rounded up to the next tick.
+  static Timer *after(uint32_t us, Callback cb, TimerMode mode = TIMER_DEFERRED);
+  static Timer *after(uint32_t us, CallbackArg cb, void *arg, TimerMode mode = TIMER_DEFERRED);
+
+  // Disarms the timer and returns it to the pool; a deferred callback
+  // already due is dropped
+  void cancel();
+
+  bool active() const;
+
+  // Number of timers free in the pool
+  static uint32_t available();
+
+private:
+  friend void ::timerTick(void);
+  friend void ::timerRunDeferred(void);
+
+  static Timer *start(uint32_t ticks, uint32_t period, CallbackArg cb, void *arg, TimerMode mode);
+  static void callNoArg(void *arg);
+
+  void link();
+  void unlink();
+  void expire();
+  void release();
+
+  Timer *_next;
+  Timer **_pprev;       // The pointer to this timer in its slot's list
+  Timer *_nextDeferred;
+  uint32_t _expires;    // Tick at which the timer fires
+  uint32_t _period;     // Ticks between calls; 0 for a one-shot timer
+  CallbackArg _callback;
+  void *_arg;
+  uint8_t _mode;
+  volatile uint8_t _state;
+};
+
+#endif
@@ -18,6 +18,9 @@
 */
 
 #include "Tone.h"
+#include "PWM.h"
+#include "TimerWheel.h"
+#include "wiring_private.h"
 #include "variant.h"
 
 #if defined(__SAMD51__) 
@@ -70,8 +73,114 @@ void toneAccurateClock (uint32_t accurateSystemCoreClockFrequency)
   toneMaxFrequency = accurateSystemCoreClockFrequency / 2;
 }
 
+static bool hwToneEnabled = false;
+
+void toneHardware (bool enable)
+{
+  hwToneEnabled = enable;
+}
+
+// Hardware tones, one per TCC
+static struct {
+  uint32_t pin;
+  Timer *end;
+  volatile bool active;
+} hwTones[TCC_INST_NUM];
+
+static bool pinTCC (uint32_t pin, uint8_t *tcNum)
+{
+  int32_t pwmChannel = g_APinDescription[pin].ulPWMChannel;
+
+  if (pwmChannel == NOT_ON_PWM || GetTCNumber(pwmChannel) >= TCC_INST_NUM)
+    return false;
+
+  *tcNum = GetTCNumber(pwmChannel);
+  return true;
+}
+
+static bool hwTonePin (uint32_t pin, uint8_t *tcNum)
+{
+  if (!hwToneEnabled || !pinTCC(pin, tcNum))
+    return false;
+
+  // Resetting the TCC would stop analogWrite() on its other pins
+  return !analogWriteTimerInUse(*tcNum);
+}
+
+static void hwToneStop (uint8_t tcNum)
+{
+  PWM pwm(hwTones[tcNum].pin);
+
+  hwTones[tcNum].active = false;
+  // analogWrite() may have set the TCC up again since the tone started
+  if (!analogWriteTimerInUse(tcNum))
+    pwm.end();
+  pinMode(hwTones[tcNum].pin, OUTPUT);
+  digitalWrite(hwTones[tcNum].pin, LOW);
+}
+
+// The one interrupt of a hardware tone, from the timer wheel. The timer
+// is periodic only to take the duration in milliseconds; it fires once.
+static void hwToneEnd (void *tcNum)
+{
+  hwTones[(uint32_t)tcNum].end->cancel();
+  hwTones[(uint32_t)tcNum].end = NULL;
+  hwToneStop((uint32_t)tcNum);
+}
+
+static bool hwTone (uint32_t outputPin, uint32_t frequency, uint32_t duration)
+{
+  uint8_t tcNum;
+
+  if (!hwTonePin(outputPin, &tcNum))
+    return false;
+
+  if (hwTones[tcNum].end) {
+    hwTones[tcNum].end->cancel();
+    hwTones[tcNum].end = NULL;
+  }
+  if (hwTones[tcNum].active && hwTones[tcNum].pin != outputPin)
+    hwToneStop(tcNum);
+
+  // Out of the TCC's range: the software tone takes the pin
+  PWM pwm(outputPin);
+  if (!pwm.begin(frequency > 0 ? frequency : 1000)) {
+    if (hwTones[tcNum].active)
+      hwToneStop(tcNum);
+    return false;
+  }
+
+  // The pin may have fallen back to the software tone before
+  if (toneIsActive && outputPin == lastOutputPin) {
+    resetTC(TONE_TC);
+    toneIsActive = false;
+  }
+
+  // A rest keeps the pin low for the duration
+  pwm.write(outputPin, frequency > 0 ? pwm.period() / 2 : 0);
+
+  hwTones[tcNum].pin = outputPin;
+  hwTones[tcNum].active = true;
+
+  if (duration > 0) {
+    // The wheel reaches 2^31 ms ahead, over 24 days
+    if (duration > INT32_MAX)
+      duration = INT32_MAX;
+    hwTones[tcNum].end = Timer::every(duration, hwToneEnd, (void *)(uint32_t)tcNum, TIMER_ISR);
+    if (!hwTones[tcNum].end) {
+      // No timer left: the software tone can keep time instead
+      hwToneStop(tcNum);
+      return false;
+    }
+  }
+  return true;
+}
+
 void tone (uint32_t outputPin, uint32_t frequency, uint32_t duration)
 {
+  if (hwTone(outputPin, frequency, duration))
+    return;
+
   // Configure interrupt request
   NVIC_DisableIRQ(TONE_TC_IRQn);
   NVIC_ClearPendingIRQ(TONE_TC_IRQn);
@@ -80,7 +189,7 @@ void tone (uint32_t outputPin, uint32_t frequency, uint32_t duration)
   {
     firstTimeRunning = true;
     
-    NVIC_SetPriority(TONE_TC_IRQn, 5);
+    irqAssignPriority(TONE_TC_IRQn, IRQ_CLASS_TONE);
 
 #if defined(__SAMD51__)
     GCLK->PCHCTRL[TONE_TC_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK0_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
@@ -136,7 +245,7 @@ void tone (uint32_t outputPin, uint32_t frequency, uint32_t duration)
     default: break;
   }
 
-  toggleCount = (duration > 0 ? frequency * duration * 2 / 1000UL : -1LL);
+  toggleCount = (duration > 0 ? (uint64_t)frequency * duration * 2 / 1000UL : -1LL);
 
   resetTC(TONE_TC);
 
@@ -179,6 +288,18 @@ void tone (uint32_t outputPin, uint32_t frequency, uint32_t duration)
 
 void noTone (uint32_t outputPin)
 {
+  uint8_t tcNum;
+
+  if (pinTCC(outputPin, &tcNum) && hwTones[tcNum].pin == outputPin &&
+      (hwTones[tcNum].active || hwTones[tcNum].end)) {
+    if (hwTones[tcNum].end) {
+      hwTones[tcNum].end->cancel();
+      hwTones[tcNum].end = NULL;
+    }
+    hwToneStop(tcNum);
+    return;
+  }
+
   resetTC(TONE_TC);
   digitalWrite(outputPin, LOW);
   toneIsActive = false;
@@ -25,4 +25,18 @@
 void tone(uint32_t _pin, uint32_t frequency, uint32_t duration = 0);
 void noTone(uint32_t _pin);
 
+/*
+ * Off by default. When enabled, tone() on a pin driven by a TCC outputs a
+ * 50% square wave straight from the timer (NPWM through the PWM class),
+ * with no interrupt per edge. Such tones play at the same time as each
+ * other, one per TCC, and as the one software tone. A duration ends with
+ * a single Timer callback.
+ *
+ * The TCC is taken over while the tone plays, so a second tone on the same
+ * TCC replaces the first. A TCC already running analogWrite() PWM is left
+ * alone, and its pins get the software tone, which toggles the pin from a
+ * TC interrupt and plays on one pin at a time.
+ */
+void toneHardware(bool enable);
+
 #endif
@@ -377,16 +377,16 @@ void USBDeviceClass::init()
 	// Configure interrupts
 #if defined(__SAMD51__)
 	/* Attach to the USB host */
-	NVIC_SetPriority(USB_0_IRQn, 0UL);
-	NVIC_SetPriority(USB_1_IRQn, 0UL);
-	NVIC_SetPriority(USB_2_IRQn, 0UL);
-	NVIC_SetPriority(USB_3_IRQn, 0UL);
+	irqAssignPriority(USB_0_IRQn, IRQ_CLASS_USB);
+	irqAssignPriority(USB_1_IRQn, IRQ_CLASS_USB);
+	irqAssignPriority(USB_2_IRQn, IRQ_CLASS_USB);
+	irqAssignPriority(USB_3_IRQn, IRQ_CLASS_USB);
 	NVIC_EnableIRQ(USB_0_IRQn);
 	NVIC_EnableIRQ(USB_1_IRQn);
 	NVIC_EnableIRQ(USB_2_IRQn);
 	NVIC_EnableIRQ(USB_3_IRQn);
 #else
-	NVIC_SetPriority((IRQn_Type) USB_IRQn, 0UL);
+	irqAssignPriority((IRQn_Type) USB_IRQn, IRQ_CLASS_USB);
 	NVIC_EnableIRQ((IRQn_Type) USB_IRQn);
 #endif
 
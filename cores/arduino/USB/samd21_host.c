@@ -190,17 +190,17 @@ void UHD_Init(void)
 
 	// Configure interrupts
 #if defined(__SAMD51__)
-	NVIC_SetPriority((IRQn_Type)USB_0_IRQn, 0UL);
-	NVIC_SetPriority((IRQn_Type)USB_1_IRQn, 0UL);
-	NVIC_SetPriority((IRQn_Type)USB_2_IRQn, 0UL);
-	NVIC_SetPriority((IRQn_Type)USB_3_IRQn, 0UL);
+	irqAssignPriority((IRQn_Type)USB_0_IRQn, IRQ_CLASS_USB);
+	irqAssignPriority((IRQn_Type)USB_1_IRQn, IRQ_CLASS_USB);
+	irqAssignPriority((IRQn_Type)USB_2_IRQn, IRQ_CLASS_USB);
+	irqAssignPriority((IRQn_Type)USB_3_IRQn, IRQ_CLASS_USB);
 
 	NVIC_EnableIRQ((IRQn_Type)USB_0_IRQn);
 	NVIC_EnableIRQ((IRQn_Type)USB_1_IRQn);
 	NVIC_EnableIRQ((IRQn_Type)USB_2_IRQn);
 	NVIC_EnableIRQ((IRQn_Type)USB_3_IRQn);
 #else
-	NVIC_SetPriority((IRQn_Type)USB_IRQn, 0UL);
+	irqAssignPriority((IRQn_Type)USB_IRQn, IRQ_CLASS_USB);
 	NVIC_EnableIRQ((IRQn_Type)USB_IRQn);
 #endif
 }
@@ -160,25 +160,21 @@ size_t Uart::write(const uint8_t data)
   if (sercom->isDataRegisterEmptyUART() && txBuffer.available() == 0) {
     sercom->writeDataUART(data);
   } else {
+    // with interrupts disabled, or when called from an ISR with higher or equal priority than
+    // the SERCOM IRQ, the IRQ can't free a spot; that doesn't change while spinning below
+    bool blocked = txBuffer.isFull() && irqBlockedHere(IRQ_CLASS_SERCOM);
+
     // spin lock until a spot opens up in the buffer
     while(txBuffer.isFull()) {
-      uint8_t interruptsEnabled = ((__get_PRIMASK() & 0x1) == 0);
-
-      if (interruptsEnabled) {
-        uint32_t exceptionNumber = (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk);
-
-        if (exceptionNumber == 0 ||
-              NVIC_GetPriority((IRQn_Type)(exceptionNumber - 16)) > SERCOM_NVIC_PRIORITY) {
-          // no exception or called from an ISR with lower priority,
-          // wait for free buffer spot via IRQ
-          continue;
+      if (blocked) {
+        // manually call the UART IRQ handler when the data register is empty
+        if (sercom->isDataRegisterEmptyUART()) {
+          IrqHandler();
         }
-      }
-
-      // interrupts are disabled or called from ISR with higher or equal priority than the SERCOM IRQ
-      // manually call the UART IRQ handler when the data register is empty
-      if (sercom->isDataRegisterEmptyUART()) {
-        IrqHandler();
+      } else if (__get_IPSR() == 0) {
+        // the IRQ drains the buffer meanwhile; only thread mode may yield, as
+        // yield() can run code the interrupted thread is in the middle of
+        yield();
       }
     }
 
@@ -22,17 +22,66 @@
 
 #include <string.h>
 
-static voidFuncPtr ISRcallback[EXTERNAL_NUM_INTERRUPTS];
-static uint32_t    ISRlist[EXTERNAL_NUM_INTERRUPTS];
-static uint32_t    nints; // Stores total number of attached interrupts
+static voidFuncPtrParam ISRcallback[EXTERNAL_NUM_INTERRUPTS]; // Indexed by EXTINT line
+static void *           ISRarg[EXTERNAL_NUM_INTERRUPTS];
+static uint32_t         ISRtimestamp[EXTERNAL_NUM_INTERRUPTS];
+static uint32_t         ISRstamped; // Lines attached with INTERRUPT_TIMESTAMP
+static int              enabled = 0;
+
+/*
+ * Timestamps are taken as a raw counter read on handler entry, the cheapest
+ * thing that can be done there, and turned into micros() time only for the
+ * lines that asked for it: DWT->CYCCNT on SAMD51, SysTick->VAL on SAMD21.
+ */
+#if defined(__SAMD51__)
+static inline uint32_t __stampNow(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t __stampToMicros(uint32_t stamp)
+{
+  uint32_t now = DWT->CYCCNT;
+  uint32_t us = micros();
+  return us - (now - stamp) / (VARIANT_MCK / 1000000);
+}
+#else
+static inline uint32_t __stampNow(void)
+{
+  return SysTick->VAL;
+}
+
+static uint32_t __stampToMicros(uint32_t stamp)
+{
+  uint32_t now = SysTick->VAL;
+  uint32_t us = micros();
+  // SysTick counts down and reloads from LOAD every millisecond
+  uint32_t elapsed = (stamp >= now) ? stamp - now : stamp + SysTick->LOAD + 1 - now;
+  return us - elapsed / (VARIANT_MCK / 1000000);
+}
+#endif
+
+// Runs a callback given to attachInterrupt(), which takes no argument
+static void __callNoArg(void *callback)
+{
+  ((voidFuncPtr)callback)();
+}
+
+static inline void __dispatch(uint32_t in, uint32_t stamp)
+{
+  if (ISRstamped & (1UL << in)) {
+    ISRtimestamp[in] = __stampToMicros(stamp);
+  }
+  if (ISRcallback[in]) ISRcallback[in](ISRarg[in]);
+}
 
 
 /* Configure I/O interrupt sources */
 static void __initialize()
 {
-  memset(ISRlist,     0, sizeof(ISRlist));
   memset(ISRcallback, 0, sizeof(ISRcallback));
-  nints = 0;
+  memset(ISRarg,      0, sizeof(ISRarg));
+  ISRstamped = 0;
 
 #if defined(__SAMD51__)
   ///EIC MCLK is enabled by default
@@ -41,7 +90,7 @@ static void __initialize()
     uint8_t irqn = EIC_0_IRQn + i;
     NVIC_DisableIRQ(irqn);
     NVIC_ClearPendingIRQ(irqn);
-    NVIC_SetPriority(irqn, 0);
+    irqAssignPriority(irqn, IRQ_CLASS_EIC);
     NVIC_EnableIRQ(irqn);
   }
   
@@ -49,7 +98,7 @@ static void __initialize()
 #else
   NVIC_DisableIRQ(EIC_IRQn);
   NVIC_ClearPendingIRQ(EIC_IRQn);
-  NVIC_SetPriority(EIC_IRQn, 0);
+  irqAssignPriority(EIC_IRQn, IRQ_CLASS_EIC);
   NVIC_EnableIRQ(EIC_IRQn);
 
   // Enable GCLK for IEC (External Interrupt Controller)
@@ -72,16 +121,60 @@ static void __initialize()
 #endif
 }
 
+/* Set the detection mode of an EXTINT line; on SAMD51 the EIC must be disabled */
+static void __setSense(uint32_t in, uint32_t mode)
+{
+  uint32_t config;
+  uint32_t pos;
+
+  // Look for right CONFIG register to be addressed
+  if (in > EXTERNAL_INT_7) {
+    config = 1;
+    pos = (in - 8) << 2;
+  } else {
+    config = 0;
+    pos = in << 2;
+  }
+
+  EIC->CONFIG[config].reg &=~ (EIC_CONFIG_SENSE0_Msk << pos); // Reset sense mode, important when changing trigger mode during runtime
+  switch (mode)
+  {
+    case LOW:
+      EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_LOW_Val << pos;
+      break;
+
+    case HIGH:
+      EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_HIGH_Val << pos;
+      break;
+
+    case CHANGE:
+      EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_BOTH_Val << pos;
+      break;
+
+    case FALLING:
+      EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_FALL_Val << pos;
+      break;
+
+    case RISING:
+      EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_RISE_Val << pos;
+      break;
+  }
+}
+
 /*
  * \brief Specifies a named Interrupt Service Routine (ISR) to call when an interrupt occurs.
  *        Replaces any previous function that was attached to the interrupt.
  */
 void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
 {
-	static int enabled = 0;
-	uint32_t config;
-	uint32_t pos;
+	attachInterruptArg(pin, callback ? __callNoArg : NULL, (void *)callback, mode);
+}
 
+/*
+ * \brief Like attachInterrupt(), but the ISR is called with arg.
+ */
+void attachInterruptArg(uint32_t pin, voidFuncPtrParam callback, void *arg, uint32_t mode)
+{
 	#if ARDUINO_SAMD_VARIANT_COMPLIANCE >= 10606
 	EExt_Interrupts in = g_APinDescription[pin].ulExtInt;
 	#else
@@ -93,7 +186,10 @@ void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
 		__initialize();
 		enabled = 1;
 	}
-	uint32_t inMask = (1UL << in);
+
+	bool stamped = (mode & INTERRUPT_TIMESTAMP) != 0;
+	mode &= ~INTERRUPT_TIMESTAMP;
+
 	// Enable wakeup capability on pin in case being used during sleep
 	#if defined(__SAMD51__)
 	//I believe this is done automatically
@@ -132,67 +228,30 @@ void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
 
 			// Assign callback to interrupt
 			ISRcallback[EXTERNAL_INT_NMI] = callback;
+			ISRarg[EXTERNAL_INT_NMI] = arg;
 
 		} else { // Not NMI, is external interrupt
 
 			// Assign pin to EIC
 			pinPeripheral(pin, PIO_EXTINT);
 
-			// Store interrupts to service in order of when they were attached
-			// to allow for first come first serve handler
-			uint32_t current = 0;
-
-			// Check if we already have this interrupt
-			for (current=0; current<nints; current++) {
-			  if (ISRlist[current] == inMask) {
-				break;
-			  }
-			}
-			if (current == nints) {
-			  // Need to make a new entry
-			  nints++;
-			}
-			ISRlist[current] = inMask;       // List of interrupt in order of when they were attached
-			ISRcallback[current] = callback; // List of callback adresses
-
-			// Look for right CONFIG register to be addressed
-			if (in > EXTERNAL_INT_7) {
-			  config = 1;
-			  pos = (in - 8) << 2;
-			} else {
-			  config = 0;
-			  pos = in << 2;
-			}
+			// One slot per line, so the handlers find the callback without a search
+			ISRcallback[in] = callback;
+			ISRarg[in] = arg;
 
 			#if defined (__SAMD51__)
 			EIC->CTRLA.bit.ENABLE = 0;
 			while (EIC->SYNCBUSY.bit.ENABLE == 1) { }
 			#endif
 
-			EIC->CONFIG[config].reg &=~ (EIC_CONFIG_SENSE0_Msk << pos); // Reset sense mode, important when changing trigger mode during runtime
-			switch (mode)
-			{
-			  case LOW:
-				EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_LOW_Val << pos;
-				break;
-
-			  case HIGH:
-				EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_HIGH_Val << pos;
-				break;
-
-			  case CHANGE:
-				EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_BOTH_Val << pos;
-				break;
-
-			  case FALLING:
-				EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_FALL_Val << pos;
-				break;
-
-			  case RISING:
-				EIC->CONFIG[config].reg |= EIC_CONFIG_SENSE0_RISE_Val << pos;
-				break;
-			}
+			__setSense(in, mode);
+		}
+		if (stamped) {
+			ISRstamped |= 1UL << in;
+		} else {
+			ISRstamped &= ~(1UL << in);
 		}
+
 		// Enable the interrupt
 		EIC->INTENSET.reg = EIC_INTENSET_EXTINT(1 << in);
 	}
@@ -229,43 +288,99 @@ void detachInterrupt(uint32_t pin)
 #endif
   }
 
-  // Remove callback from the ISR list
-  uint32_t current;
-  for (current=0; current<nints; current++) {
-    if (ISRlist[current] == (1UL << in)) {
-      break;
-    }
-  }
-  if (current == nints) return; // We didn't have it
+  // Remove callback
+  ISRcallback[in] = NULL;
+  ISRstamped &= ~(1UL << in);
+}
 
-  // Shift the reminder down
-  for (; current<nints-1; current++) {
-    ISRlist[current]     = ISRlist[current+1];
-    ISRcallback[current] = ISRcallback[current+1];
+/*
+ * \brief micros() at the last interrupt on the pin, if attached with INTERRUPT_TIMESTAMP.
+ */
+uint32_t interruptTimestamp(uint32_t pin)
+{
+#if ARDUINO_SAMD_VARIANT_COMPLIANCE >= 10606
+  EExt_Interrupts in = g_APinDescription[pin].ulExtInt;
+#else
+  EExt_Interrupts in = digitalPinToInterrupt(pin);
+#endif
+  if (in == NOT_AN_INTERRUPT) return 0;
+
+  return ISRtimestamp[in];
+}
+
+/*
+ * \brief Routes the pin's EXTINT line to the event system instead of the CPU.
+ */
+int attachInterruptEvent(uint32_t pin, uint32_t mode)
+{
+#if ARDUINO_SAMD_VARIANT_COMPLIANCE >= 10606
+  EExt_Interrupts in = g_APinDescription[pin].ulExtInt;
+#else
+  EExt_Interrupts in = digitalPinToInterrupt(pin);
+#endif
+  if (in == NOT_AN_INTERRUPT || in == EXTERNAL_INT_NMI) return -1;
+
+  if (!enabled) {
+    __initialize();
+    enabled = 1;
   }
-  nints--;
+
+  pinPeripheral(pin, PIO_EXTINT);
+
+#if defined (__SAMD51__)
+  EIC->CTRLA.bit.ENABLE = 0;
+  while (EIC->SYNCBUSY.bit.ENABLE == 1) { }
+#endif
+
+  __setSense(in, mode);
+  EIC->INTENCLR.reg = EIC_INTENCLR_EXTINT(1 << in);
+  EIC->EVCTRL.reg |= EIC_EVCTRL_EXTINTEO(1 << in);
+
+#if defined (__SAMD51__)
+  EIC->CTRLA.bit.ENABLE = 1;
+  while (EIC->SYNCBUSY.bit.ENABLE == 1) { }
+#endif
+
+  return in;
+}
+
+/*
+ * \brief Stops the pin's EXTINT line from generating events.
+ */
+void detachInterruptEvent(uint32_t pin)
+{
+#if ARDUINO_SAMD_VARIANT_COMPLIANCE >= 10606
+  EExt_Interrupts in = g_APinDescription[pin].ulExtInt;
+#else
+  EExt_Interrupts in = digitalPinToInterrupt(pin);
+#endif
+  if (in == NOT_AN_INTERRUPT || in == EXTERNAL_INT_NMI) return;
+
+#if defined (__SAMD51__)
+  EIC->CTRLA.bit.ENABLE = 0;
+  while (EIC->SYNCBUSY.bit.ENABLE == 1) { }
+#endif
+
+  EIC->EVCTRL.reg &= ~EIC_EVCTRL_EXTINTEO(1 << in);
+
+#if defined (__SAMD51__)
+  EIC->CTRLA.bit.ENABLE = 1;
+  while (EIC->SYNCBUSY.bit.ENABLE == 1) { }
+#endif
 }
 
 /*
  * External Interrupt Controller NVIC Interrupt Handler
  */
 #if defined(__SAMD51__)
-void InterruptHandler(uint32_t i)
+// Each line has its own vector, so the line is known without reading INTFLAG
+static inline void InterruptHandler(uint32_t i)
 {
-  // Calling the routine directly from -here- takes about 1us
-  // Depending on where you are in the list it will take longer
+  uint32_t stamp = __stampNow();
 
-  // Loop over all enabled interrupts in the list
-  for (uint32_t i=0; i<nints; i++)
-  {
-	if ((EIC->INTFLAG.reg & ISRlist[i]) != 0)
-	{
-	  // Call the callback function
-	  ISRcallback[i]();
-	  // Clear the interrupt
-	  EIC->INTFLAG.reg = ISRlist[i];
-	}
-  }
+  // Clear first, so an edge arriving during the callback isn't lost
+  EIC->INTFLAG.reg = 1UL << i;
+  __dispatch(i, stamp);
 }
 
 void EIC_0_Handler(void)
@@ -351,19 +466,20 @@ void EIC_15_Handler(void)
 
 void EIC_Handler(void)
 {
-  // Calling the routine directly from -here- takes about 1us
-  // Depending on where you are in the list it will take longer
+  uint32_t stamp = __stampNow();
+
+  // Visit only the lines that are both pending and enabled, lowest first;
+  // any flag set again meanwhile re-triggers the handler
+  uint32_t pending = EIC->INTFLAG.reg & EIC->INTENSET.reg;
 
-  // Loop over all enabled interrupts in the list
-  for (uint32_t i=0; i<nints; i++)
+  while (pending)
   {
-    if ((EIC->INTFLAG.reg & ISRlist[i]) != 0)
-    {
-      // Call the callback function
-      ISRcallback[i]();
-      // Clear the interrupt
-      EIC->INTFLAG.reg = ISRlist[i];
-    }
+    uint32_t i = __builtin_ctz(pending);
+    pending &= pending - 1;
+
+    // Clear first, so an edge arriving during the callback isn't lost
+    EIC->INTFLAG.reg = 1UL << i;
+    __dispatch(i, stamp);
   }
 }
 
@@ -372,7 +488,7 @@ void EIC_Handler(void)
  */
 void NMI_Handler(void)
 {
-  if (ISRcallback[EXTERNAL_INT_NMI]) ISRcallback[EXTERNAL_INT_NMI]();
+  __dispatch(EXTERNAL_INT_NMI, __stampNow());
   EIC->NMIFLAG.bit.NMI = 1; // Clear interrupt
 }
 #endif
@@ -31,10 +31,14 @@ extern "C" {
 #define FALLING 3
 #define RISING 4
 
+// OR into the mode of attachInterrupt() to record the time of each edge
+#define INTERRUPT_TIMESTAMP 0x100
+
 #define DEFAULT 1
 #define EXTERNAL 0
 
 typedef void (*voidFuncPtr)(void);
+typedef void (*voidFuncPtrParam)(void *);
 
 /*
  * \brief Specifies a named Interrupt Service Routine (ISR) to call when an interrupt occurs.
@@ -42,11 +46,38 @@ typedef void (*voidFuncPtr)(void);
  */
 void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode);
 
+/*
+ * \brief Like attachInterrupt(), but the ISR is called with arg, e.g. the object
+ *        a C++ driver wants the interrupt delivered to.
+ */
+void attachInterruptArg(uint32_t pin, voidFuncPtrParam callback, void *arg, uint32_t mode);
+
 /*
  * \brief Turns off the given interrupt.
  */
 void detachInterrupt(uint32_t pin);
 
+/*
+ * \brief The micros() time of the pin's last interrupt, for pins attached with
+ *        INTERRUPT_TIMESTAMP. It is taken on entry to the EIC handler, so it doesn't
+ *        include time spent in earlier callbacks or in the callback itself; call it
+ *        from the ISR to get the time of the edge being handled.
+ */
+uint32_t interruptTimestamp(uint32_t pin);
+
+/*
+ * \brief Routes the pin's external interrupt line to the event system instead of the CPU.
+ *        mode is as for attachInterrupt(); HIGH or LOW pass the pin level through as the event.
+ *
+ * \return The EXTINT line number (for EVSYS_ID_GEN_EIC_EXTINT_0 + n), or -1 if the pin has none.
+ */
+int attachInterruptEvent(uint32_t pin, uint32_t mode);
+
+/*
+ * \brief Stops the pin's external interrupt line from generating events.
+ */
+void detachInterruptEvent(uint32_t pin);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,110 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "WorkQueue.h"
+#include "ISRProfiler.h"
+
+#if (WORK_QUEUE_SIZE & (WORK_QUEUE_SIZE - 1)) != 0
+#error "WORK_QUEUE_SIZE must be a power of two"
+#endif
+
+#define WORK_QUEUE_MASK (WORK_QUEUE_SIZE - 1)
+
+typedef struct {
+  volatile WorkFunction fn;   // NULL until the item is complete
+  void *arg;
+} WorkItem;
+
+static WorkItem queue[WORK_QUEUE_SIZE];
+static volatile uint32_t queueHead;   // Next slot to reserve
+static volatile uint32_t queueTail;   // Next slot to run
+
+static bool reserve(uint32_t *slot)
+{
+  uint32_t head;
+
+#if defined(__SAMD51__)
+  do {
+    head = __LDREXW((uint32_t *)&queueHead);
+    if (head - queueTail >= WORK_QUEUE_SIZE) {
+      __CLREX();
+      return false;
+    }
+  } while (__STREXW(head + 1, (uint32_t *)&queueHead));
+#else
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  head = queueHead;
+  if (head - queueTail >= WORK_QUEUE_SIZE) {
+    __set_PRIMASK(primask);
+    return false;
+  }
+  queueHead = head + 1;
+  __set_PRIMASK(primask);
+#endif
+
+  *slot = head & WORK_QUEUE_MASK;
+  return true;
+}
+
+bool workPost(WorkFunction fn, void *arg)
+{
+  uint32_t slot;
+
+  if (fn == NULL || !reserve(&slot)) {
+    return false;
+  }
+
+  queue[slot].arg = arg;
+  __DMB();
+  queue[slot].fn = fn;
+
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  return true;
+}
+
+static void runQueue(void)
+{
+  for (;;) {
+    WorkItem *item = &queue[queueTail & WORK_QUEUE_MASK];
+    WorkFunction fn = item->fn;
+
+    // Empty, or the next item is still being posted by the code PendSV
+    // preempted, which pends PendSV again once it is done
+    if (fn == NULL) {
+      break;
+    }
+
+    void *arg = item->arg;
+    item->fn = NULL;
+    __DMB();
+    queueTail++;
+
+    fn(arg);
+  }
+}
+
+void workQueueRun(void)
+{
+#if defined(ISR_PROFILER)
+  isrProfilerPendSV(runQueue);
+#else
+  runQueue();
+#endif
+}
@@ -0,0 +1,58 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Deferred interrupt work ("bottom halves").
+ *
+ * An interrupt handler posts the slow part of its work, such as calling a
+ * user callback, and returns. The work runs in PendSV at the lowest
+ * interrupt priority, in posting order, as soon as no other handler is
+ * active: before loop() resumes, but without holding off any interrupt.
+ *
+ * Posting takes no lock: a slot is reserved with LDREX/STREX on SAMD51
+ * and with interrupts disabled for a few instructions on SAMD21, which
+ * lacks them. The queue holds WORK_QUEUE_SIZE items, a power of two that
+ * may be set from variant.h; workPost() returns false when it is full, and
+ * the caller should then do the work itself.
+ */
+
+#ifndef WORK_QUEUE_SIZE
+#define WORK_QUEUE_SIZE 32
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*WorkFunction)(void *arg);
+
+// Queues fn(arg); may be called from any handler or from loop()
+bool workPost(WorkFunction fn, void *arg);
+
+// Runs the queued work; called by the default PendSV_Handler. A sketch or
+// RTOS that defines its own PendSV_Handler must call it from there.
+void workQueueRun(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,6 +20,7 @@
 #include <sam.h>
 #include <variant.h>
 #include <stdio.h>
+#include "ISRProfiler.h"
 
 /* RTOS Hooks */
 extern void svcHook(void);
@@ -35,6 +36,33 @@ void Dummy_Handler(void)
   for (;;) { }
 }
 
+/*
+ * Default PendSV handler: runs the deferred work of WorkQueue.c, then jumps
+ * to the task switch of task_switch.S with the EXC_RETURN still in lr. Both
+ * are referenced weakly, so neither is linked in unless used, and a sketch
+ * or RTOS can still define a PendSV_Handler of its own.
+ */
+__attribute__ ((weak, naked)) void PendSV_Handler(void)
+{
+  __asm__ volatile (
+    "	.weak	workQueueRun\n"
+    "	.weak	taskSwitchRun\n"
+    "	push	{r0, lr}\n"
+    "	ldr	r0, =workQueueRun\n"
+    "	cmp	r0, #0\n"
+    "	beq	1f\n"
+    "	blx	r0\n"
+    "1:	pop	{r0, r1}\n"
+    "	mov	lr, r1\n"
+    "	ldr	r0, =taskSwitchRun\n"
+    "	cmp	r0, #0\n"
+    "	beq	2f\n"
+    "	bx	r0\n"
+    "2:	bx	lr\n"
+    "	.pool\n"
+  );
+}
+
 #if defined(__SAMD51__)
 
 /* Cortex-M4 processor handlers */
@@ -46,7 +74,7 @@ void BusFault_Handler            ( void ) __attribute__ ((weak, alias("Dummy_Han
 void UsageFault_Handler          ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 void SVC_Handler                 ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 void DebugMon_Handler            ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
-void PendSV_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
+void PendSV_Handler              ( void ) __attribute__ ((weak));
 void SysTick_Handler			 ( void );
 
 /* Peripherals handlers */
@@ -165,9 +193,9 @@ void PDEC_0_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Han
 void PDEC_1_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 void PDEC_2_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 void ADC0_0_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
-void ADC0_1_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
+void ADC0_1_Handler              ( void ) __attribute__ ((weak)); // Used in wiring_analog.c
 void ADC1_0_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
-void ADC1_1_Handler              ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
+void ADC1_1_Handler              ( void ) __attribute__ ((weak)); // Used in wiring_analog.c
 void AC_Handler                  ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 void DAC_0_Handler               ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 void DAC_1_Handler               ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
@@ -362,7 +390,7 @@ void HardFault_Handler(void) __attribute__ ((weak, alias("Dummy_Handler")));
 void Reset_Handler    (void);
 void NMI_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
 void SVC_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
-void PendSV_Handler   (void) __attribute__ ((weak, alias("Dummy_Handler")));
+void PendSV_Handler   (void) __attribute__ ((weak));
 void SysTick_Handler  (void);
 
 /* Peripherals handlers */
@@ -389,7 +417,7 @@ void TC4_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
 void TC5_Handler      (void) __attribute__ ((weak)); // Used in Tone.cpp
 void TC6_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
 void TC7_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
-void ADC_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
+void ADC_Handler      (void) __attribute__ ((weak)); // Used in wiring_analog.c
 void AC_Handler       (void) __attribute__ ((weak, alias("Dummy_Handler")));
 void DAC_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
 void PTC_Handler      (void) __attribute__ ((weak, alias("Dummy_Handler")));
@@ -490,6 +518,10 @@ void Reset_Handler(void)
 
   SystemInit();
 
+#if defined(ISR_PROFILER)
+  isrProfilerInstall();
+#endif
+
   main();
 
   while (1)
@@ -23,8 +23,279 @@
 extern "C" {
 #endif
 
+// The timer wheel (see TimerWheel.h) is referenced weakly so it isn't
+// linked in unless a sketch uses Timer
+extern void timerTick(void) __attribute__ ((weak));
+extern void timerRunDeferred(void) __attribute__ ((weak));
+
+#define CYCLES_PER_MS (VARIANT_MCK / 1000)
+#define CYCLES_PER_US (VARIANT_MCK / 1000000)
+
+#if defined(TICKLESS)
+/*
+ * Tickless timebase: time is kept by the RTC counting the 32.768kHz clock,
+ * and SysTick runs without its interrupt (only its VAL is used, for
+ * interrupt timestamps). The CPU is woken only by the RTC overflow every
+ * 36 hours and by the compare programmed by delay(), which sleeps in WFI.
+ *
+ * millis() and micros() then have a resolution of 1/32768 s (about 30us);
+ * delayMicroseconds() still counts CPU cycles. The RTC is taken for the
+ * timebase, so the RTCZero library can't be used along with TICKLESS.
+ */
+
+#define RTC_FREQ_SHIFT 15   // 32768 Hz
+
+/** Upper half of the 64-bit RTC count */
+static volatile uint32_t _ulRtcHigh=0 ;
+
+static inline void rtcSync( void )
+{
+#ifdef __SAMD51__
+  while (RTC->MODE0.SYNCBUSY.reg)
+    ;
+#else
+  while (RTC->MODE0.STATUS.bit.SYNCBUSY)
+    ;
+#endif
+}
+
+void initTimebase( void )
+{
+  // SysTick keeps counting for the timestamps, but no longer interrupts
+  SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+
+#ifdef __SAMD51__
+  MCLK->APBAMASK.reg |= MCLK_APBAMASK_RTC;
+#if defined(CRYSTALLESS)
+  OSC32KCTRL->RTCCTRL.reg = OSC32KCTRL_RTCCTRL_RTCSEL_ULP32K;
+#else
+  OSC32KCTRL->RTCCTRL.reg = OSC32KCTRL_RTCCTRL_RTCSEL_XOSC32K;
+#endif
+
+  RTC->MODE0.CTRLA.reg = RTC_MODE0_CTRLA_SWRST;
+  while (RTC->MODE0.SYNCBUSY.bit.SWRST)
+    ;
+
+  // COUNTSYNC keeps COUNT readable without a request per read
+  RTC->MODE0.CTRLA.reg = RTC_MODE0_CTRLA_MODE_COUNT32 | RTC_MODE0_CTRLA_PRESCALER_DIV1 |
+                         RTC_MODE0_CTRLA_COUNTSYNC;
+  rtcSync();
+  RTC->MODE0.CTRLA.reg |= RTC_MODE0_CTRLA_ENABLE;
+  rtcSync();
+#else
+  PM->APBAMASK.reg |= PM_APBAMASK_RTC;
+
+  // Generic clock 1 runs from the 32.768kHz oscillator (see startup.c)
+  GCLK->CLKCTRL.reg = (uint16_t) (GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK1 | GCLK_CLKCTRL_ID(GCM_RTC));
+  while (GCLK->STATUS.bit.SYNCBUSY)
+    ;
+
+  RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_SWRST;
+  while (RTC->MODE0.CTRL.bit.SWRST)
+    ;
+
+  RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_MODE_COUNT32 | RTC_MODE0_CTRL_PRESCALER_DIV1;
+  rtcSync();
+  RTC->MODE0.CTRL.reg |= RTC_MODE0_CTRL_ENABLE;
+  rtcSync();
+
+  // Continuous read synchronization of COUNT
+  RTC->MODE0.READREQ.reg = RTC_READREQ_RCONT | RTC_READREQ_RREQ | RTC_READREQ_ADDR(RTC_MODE0_COUNT_OFFSET);
+  rtcSync();
+#endif
+
+  RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_OVF | RTC_MODE0_INTFLAG_CMP0;
+  RTC->MODE0.INTENSET.reg = RTC_MODE0_INTENSET_OVF;
+
+  irqAssignPriority(RTC_IRQn, IRQ_CLASS_SYSTICK);
+  NVIC_ClearPendingIRQ(RTC_IRQn);
+  NVIC_EnableIRQ(RTC_IRQn);
+}
+
+/*
+ * The 64-bit RTC count. An overflow not yet handled, because it happened
+ * meanwhile or RTC_Handler is blocked by a higher priority interrupt, is
+ * accounted for here. Whether COUNT was read before or after the wrap
+ * shows in its top bit, as the count read may lag the flag by a few clocks.
+ */
+static uint64_t readRtc( void )
+{
+  uint32_t high, count, pend;
+
+  do {
+    high  = _ulRtcHigh;
+    count = RTC->MODE0.COUNT.reg;
+    pend  = RTC->MODE0.INTFLAG.reg & RTC_MODE0_INTFLAG_OVF;
+  } while (high != _ulRtcHigh);
+
+  if (pend && count < 0x80000000) {
+    high++;
+  }
+
+  return ((uint64_t)high << 32) | count;
+}
+
+/*
+ * count * rate / 32768, without the product overflowing: whole seconds and
+ * the fraction are scaled separately. count * VARIANT_MCK alone would
+ * overflow 64 bits after 48 days at 120MHz.
+ */
+static inline uint64_t rtcScale( uint64_t count, uint32_t rate )
+{
+  uint32_t fraction = (uint32_t)count & ((1ul << RTC_FREQ_SHIFT) - 1);
+
+  return (count >> RTC_FREQ_SHIFT) * rate +
+         (((uint64_t)fraction * rate) >> RTC_FREQ_SHIFT);
+}
+
+unsigned long millis( void )
+{
+  return (uint32_t)millis64();
+}
+
+uint64_t millis64( void )
+{
+  return rtcScale(readRtc(), 1000);
+}
+
+unsigned long micros( void )
+{
+  return (uint32_t)micros64();
+}
+
+uint64_t micros64( void )
+{
+  return rtcScale(readRtc(), 1000000);
+}
+
+uint64_t cycles64( void )
+{
+  return rtcScale(readRtc(), VARIANT_MCK);
+}
+
+void RTC_Handler( void )
+{
+  // Atomic for readers in higher priority interrupts, as in SysTick_Handler
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint8_t flags = RTC->MODE0.INTFLAG.reg;
+  if (flags & RTC_MODE0_INTFLAG_OVF) {
+    _ulRtcHigh++;
+  }
+  // CMP0 only has to wake the CPU from delay()
+  RTC->MODE0.INTFLAG.reg = flags;
+  __set_PRIMASK(primask);
+}
+
+/** Users keeping the SysTick interrupt on */
+static uint32_t _ulTickUsers=0 ;
+
+void tickRequest( void )
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (_ulTickUsers++ == 0) {
+    SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+  }
+  __set_PRIMASK(primask);
+}
+
+void tickRelease( void )
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (_ulTickUsers > 0 && --_ulTickUsers == 0) {
+    SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+  }
+  __set_PRIMASK(primask);
+}
+
+#else
+
 /** Tick Counter united by ms */
 static volatile uint32_t _ulTickCount=0 ;
+/** Upper half of the 64-bit tick count */
+static volatile uint32_t _ulTickCountHigh=0 ;
+/** Incremented with each tick, so readers can detect one happening meanwhile */
+static volatile uint32_t _ulTickSeq=0 ;
+
+#ifdef __SAMD51__
+/** DWT->CYCCNT at the last SysTick reload */
+static volatile uint32_t _ulTickCycles=0 ;
+#endif
+
+void initTimebase( void )
+{
+#ifdef __SAMD51__
+  // SysTick and the DWT cycle counter both run from the CPU clock, so the
+  // reload points found here stay exactly CYCLES_PER_MS apart
+  uint32_t cycles = DWT->CYCCNT;
+  uint32_t ticks = SysTick->VAL;
+  _ulTickCycles = cycles - (SysTick->LOAD - ticks);
+#endif
+}
+
+/*
+ * Takes a consistent snapshot of the tick count and the cycles elapsed
+ * since that tick. The cycles may exceed one tick if SysTick is pending
+ * behind a higher priority interrupt; the sum stays correct either way.
+ */
+static inline void readTimebase( uint64_t *ms, uint32_t *cycles )
+{
+  uint32_t seq;
+  uint32_t low, high;
+
+#ifdef __SAMD51__
+  uint32_t base, now;
+
+  do {
+    seq  = _ulTickSeq;
+    low  = _ulTickCount;
+    high = _ulTickCountHigh;
+    base = _ulTickCycles;
+    now  = DWT->CYCCNT;
+  } while (seq != _ulTickSeq);
+
+  *cycles = now - base;
+#else
+  uint32_t ticks, pend;
+
+  do {
+    seq   = _ulTickSeq;
+    low   = _ulTickCount;
+    high  = _ulTickCountHigh;
+    ticks = SysTick->VAL;
+    pend  = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    if (pend) {
+      // SysTick wrapped, possibly after VAL was read: read it again
+      ticks = SysTick->VAL;
+    }
+  } while (seq != _ulTickSeq);
+
+  *cycles = (SysTick->LOAD - ticks) + (pend ? SysTick->LOAD + 1 : 0);
+#endif
+
+  *ms = ((uint64_t)high << 32) | low;
+}
+
+void tickRequest( void )
+{
+}
+
+void tickRelease( void )
+{
+}
+
+static inline uint32_t cyclesToMicros( uint32_t cycles )
+{
+#ifdef __SAMD51__
+  return cycles / CYCLES_PER_US;
+#else
+  // No divide instruction on the M0+: multiply and shift instead, which is
+  // exact enough for the at most two ticks readTimebase() returns here
+  return (cycles * (1048576 / CYCLES_PER_US)) >> 20;
+#endif
+}
 
 unsigned long millis( void )
 {
@@ -32,35 +303,45 @@ unsigned long millis( void )
   return _ulTickCount ;
 }
 
-// Interrupt-compatible version of micros
-// Theory: repeatedly take readings of SysTick counter, millis counter and SysTick interrupt pending flag.
-// When it appears that millis counter and pending is stable and SysTick hasn't rolled over, use these
-// values to calculate micros. If there is a pending SysTick, add one to the millis counter in the calculation.
+uint64_t millis64( void )
+{
+  uint64_t ms;
+  uint32_t cycles;
+
+  readTimebase(&ms, &cycles);
+  return ms;
+}
+
+// Only the low 32 bits of micros64(), which 32-bit arithmetic gets exactly
 unsigned long micros( void )
 {
-  uint32_t ticks, ticks2;
-  uint32_t pend, pend2;
-  uint32_t count, count2;
+  uint64_t ms;
+  uint32_t cycles;
 
-  ticks2  = SysTick->VAL;
-  pend2   = !!(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)  ;
-  count2  = _ulTickCount ;
+  readTimebase(&ms, &cycles);
+  return ((uint32_t)ms * 1000) + cyclesToMicros(cycles);
+}
 
-  do
-  {
-    ticks=ticks2;
-    pend=pend2;
-    count=count2;
-    ticks2  = SysTick->VAL;
-    pend2   = !!(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)  ;
-    count2  = _ulTickCount ;
-  } while ((pend != pend2) || (count != count2) || (ticks < ticks2));
+uint64_t micros64( void )
+{
+  uint64_t ms;
+  uint32_t cycles;
 
-  return ((count+pend) * 1000) + (((SysTick->LOAD  - ticks)*(1048576/(VARIANT_MCK/1000000)))>>20) ;
-  // this is an optimization to turn a runtime division into two compile-time divisions and
-  // a runtime multiplication and shift, saving a few cycles
+  readTimebase(&ms, &cycles);
+  return (ms * 1000) + cyclesToMicros(cycles);
 }
 
+uint64_t cycles64( void )
+{
+  uint64_t ms;
+  uint32_t cycles;
+
+  readTimebase(&ms, &cycles);
+  return (ms * CYCLES_PER_MS) + cycles;
+}
+
+#endif // TICKLESS
+
 #ifdef __SAMD51__
 /*
  * On SAMD51, use the (32bit) cycle count maintained by the DWT unit,
@@ -85,9 +366,107 @@ void delayMicroseconds(unsigned int us)
       return;
   }
 }
+#else
+/*
+ * On SAMD21, count the cycles elapsed on SysTick, which runs from the CPU
+ * clock in every build (see initTimebase()). Unlike a counted loop this
+ * doesn't depend on flash wait states, code alignment or the time taken
+ * by interrupts. SysTick counts down and reloads every millisecond; a
+ * higher VAL than the last one read means it wrapped in between. Should
+ * interrupts hold up the loop for longer than 1ms, a wrap is missed and
+ * the delay gets longer, never shorter. The overhead of the call and the
+ * setup is about 16 cycles (1/3 us at 48MHz).
+ */
+void delayMicroseconds(unsigned int us)
+{
+  uint32_t count, elapsed, reload, last, now;
+
+  if (us == 0)
+    return;
+
+  count = us * CYCLES_PER_US;
+
+  if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+    // Before init(): the former loop of 3 cycles per pass, without wait states
+    count /= 3;
+    __asm__ __volatile__(
+      "1:              \n"
+      "   sub %0, #1   \n"
+      "   bne 1b       \n"
+      : "+r" (count)
+    );
+    return;
+  }
+
+  if (count <= 16)
+    return;
+  count -= 16;
+
+  reload = SysTick->LOAD + 1;
+  last = SysTick->VAL;
+  elapsed = 0;
+  while (elapsed < count) {
+    now = SysTick->VAL;
+    elapsed += (now <= last) ? last - now : last + reload - now;
+    last = now;
+  }
+}
 #endif
 
 
+#if defined(TICKLESS)
+void delay( unsigned long ms )
+{
+  if (ms == 0)
+  {
+    return;
+  }
+
+  uint64_t end = readRtc() + ((((uint64_t)ms << RTC_FREQ_SHIFT) + 999) / 1000);
+
+  // Where the RTC interrupt can't preempt, it can't end a WFI either, so
+  // the RTC is polled instead
+  bool sleep = !irqBlockedHere(IRQ_CLASS_SYSTICK);
+
+  // A delay() in an interrupt handler gives the compare back afterwards
+  bool nested = RTC->MODE0.INTENSET.reg & RTC_MODE0_INTENSET_CMP0;
+  uint32_t outer = RTC->MODE0.COMP[0].reg;
+
+  // The compare matches the low 32 bits; an early match only costs a wakeup
+  RTC->MODE0.COMP[0].reg = (uint32_t)end;
+  rtcSync();
+  RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+  RTC->MODE0.INTENSET.reg = RTC_MODE0_INTENSET_CMP0;
+
+  while (readRtc() < end)
+  {
+    yield();
+    if (timerRunDeferred)
+      timerRunDeferred();
+
+    // Interrupts disabled, so one arriving between the check and WFI
+    // still ends the sleep
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (sleep && readRtc() < end)
+    {
+      __DSB();
+      __WFI();
+    }
+    __set_PRIMASK(primask);
+  }
+
+  if (nested)
+  {
+    RTC->MODE0.COMP[0].reg = outer;
+    rtcSync();
+  }
+  else
+  {
+    RTC->MODE0.INTENCLR.reg = RTC_MODE0_INTENCLR_CMP0;
+  }
+}
+#else
 void delay( unsigned long ms )
 {
   if (ms == 0)
@@ -100,6 +479,8 @@ void delay( unsigned long ms )
   while (ms > 0)
   {
     yield();
+    if (timerRunDeferred)
+      timerRunDeferred();
     while (ms > 0 && (micros() - start) >= 1000)
     {
       ms--;
@@ -107,13 +488,29 @@ void delay( unsigned long ms )
     }
   }
 }
+#endif
 
 #include "Reset.h" // for tickReset()
 
 void SysTick_DefaultHandler(void)
 {
-  // Increment tick count each ms
-  _ulTickCount++;
+#if !defined(TICKLESS)
+  // Increment tick count each ms. This is atomic for readers in higher
+  // priority interrupts, which can't wait for the handler to finish.
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (++_ulTickCount == 0) {
+    _ulTickCountHigh++;
+  }
+#ifdef __SAMD51__
+  _ulTickCycles += CYCLES_PER_MS;
+#endif
+  _ulTickSeq++;
+  __set_PRIMASK(primask);
+#endif
+
+  if (timerTick)
+    timerTick();
   tickReset();
 }
 
@@ -48,6 +48,39 @@ extern unsigned long millis( void ) ;
  */
 extern unsigned long micros( void ) ;
 
+/**
+ * \brief 64-bit versions of millis() and micros(), which don't overflow in practice.
+ * micros() returns the low 32 bits of micros64().
+ */
+extern uint64_t millis64( void ) ;
+extern uint64_t micros64( void ) ;
+
+/**
+ * \brief Returns the number of CPU clock cycles since the timebase started, with 64 bits.
+ *
+ * Cycle-accurate and wrap-free: the millisecond tick plus the cycles since it, read from
+ * DWT->CYCCNT on SAMD51 and SysTick->VAL on SAMD21. micros() and micros64() use the same source.
+ */
+extern uint64_t cycles64( void ) ;
+
+/**
+ * \brief Aligns the timebase with SysTick; called by init() right after SysTick is started.
+ *
+ * Built with -DTICKLESS, the timebase is the 32.768kHz RTC instead and SysTick stops
+ * interrupting: millis() and micros() get a 1/32768 s resolution, delay() sleeps in WFI
+ * until an RTC compare, and the RTC is no longer available to sketches or RTCZero.
+ */
+extern void initTimebase( void ) ;
+
+/**
+ * \brief Keeps the SysTick interrupt on while at least one tickRequest() isn't released.
+ *
+ * Used by the reset countdown and the software timers, which run from SysTick. Only has
+ * an effect in the TICKLESS build: otherwise SysTick always interrupts.
+ */
+extern void tickRequest( void ) ;
+extern void tickRelease( void ) ;
+
 /**
  * \brief Pauses the program for the amount of time (in miliseconds) specified as parameter.
  * (There are 1000 milliseconds in a second.)
@@ -61,46 +94,7 @@ extern void delay( unsigned long dwMs ) ;
  *
  * \param dwUs the number of microseconds to pause (uint32_t)
  */
-#if defined(__SAMD51__)
 extern void delayMicroseconds( unsigned int );
-#else
-static __inline__ void delayMicroseconds( unsigned int ) __attribute__((always_inline, unused)) ;
-static __inline__ void delayMicroseconds( unsigned int usec )
-{
-  if ( usec == 0 )
-  {
-    return ;
-  }
-  /*
-   *  The following loop:
-   *
-   *    for (; ul; ul--) {
-   *      __asm__ volatile("");
-   *    }
-   *
-   *  produce the following assembly code:
-   *
-   *    loop:
-   *      subs r3, #1        // 1 Core cycle
-   *      bne.n loop         // 1 Core cycle + 1 if branch is taken
-   */
-
-  // VARIANT_MCK / 1000000 == cycles needed to delay 1uS
-  //                     3 == cycles used in a loop
-  uint32_t n = usec * (VARIANT_MCK / 1000000) / 3;
-
-  __asm__ __volatile__(
-    "1:              \n"
-    "   sub %0, #1   \n" // substract 1 from %0 (n)
-    "   bne 1b       \n" // if result is not 0 jump to 1
-    : "+r" (n)           // '%0' is n variable with RW constraints
-    :                    // no input
-    :                    // no clobber
-  );
-  // https://gcc.gnu.org/onlinedocs/gcc/Extended-Asm.html
-  // https://gcc.gnu.org/onlinedocs/gcc/Extended-Asm.html#Volatile
-}
-#endif
 
 #ifdef __cplusplus
 }
@@ -17,19 +17,24 @@
 */
 
 /**
- * Empty yield() hook.
+ * Default yield() hook.
  *
  * This function is intended to be used by library writers to build
  * libraries or sketches that supports cooperative threads.
  *
+ * It switches to the next task of the core scheduler (see TaskSwitch.h), which
+ * is referenced weakly so it isn't linked in unless a sketch starts a task.
  * Its defined as a weak symbol and it can be redefined to implement a
- * real cooperative scheduler.
+ * different cooperative scheduler.
  */
-static void __empty() {
-	// Empty
+extern void taskYield(void) __attribute__ ((weak));
+
+static void __yield() {
+	if (taskYield)
+		taskYield();
 }
 
-void yield(void) __attribute__ ((weak, alias("__empty")));
+void yield(void) __attribute__ ((weak, alias("__yield")));
 
 /**
  * SysTick hook
@@ -19,6 +19,9 @@
 #define ARDUINO_MAIN
 #include "Arduino.h"
 
+// Referenced weakly so the timer wheel is only linked in with Timer
+extern "C" void timerRunDeferred(void) __attribute__ ((weak));
+
 // Weak empty variant initialization function.
 // May be redefined by variant files.
 void initVariant() __attribute__((weak));
@@ -53,6 +56,7 @@ int main( void )
   {
     loop();
     yield(); // yield run usb background task
+    if (timerRunDeferred) timerRunDeferred();
 
     if (serialEventRun) serialEventRun();
   }
@@ -62,11 +66,16 @@ int main( void )
 
 #if defined(USE_TINYUSB)
 
+// Weak, as in hooks.c: only linked in when a sketch starts a task
+extern "C" void taskYield(void) __attribute__ ((weak));
+
 // run TinyUSB background task when yield()
 extern  "C" void yield(void)
 {
   tud_task();
   tud_cdc_write_flush();
+
+  if (taskYield) taskYield();
 }
 
 #endif
@@ -69,7 +69,11 @@ void init( void )
     // Capture error
     while ( 1 ) ;
   }
-  NVIC_SetPriority (SysTick_IRQn,  (1 << __NVIC_PRIO_BITS) - 2);  /* set Priority for Systick Interrupt (2nd lowest) */
+  irqAssignPriority(SysTick_IRQn, IRQ_CLASS_SYSTICK);  /* 2nd lowest by default */
+  initTimebase();
+
+  // PendSV runs deferred interrupt work and switches tasks, below all else
+  irqAssignPriority(PendSV_IRQn, IRQ_CLASS_PENDSV);
 
   // Clock PORT for Digital I/O
 //  PM->APBBMASK.reg |= PM_APBBMASK_PORT ;
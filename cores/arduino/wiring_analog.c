@@ -257,10 +257,9 @@ void analogReference(eAnalogReference mode)
 #endif
 }
 
-uint32_t analogRead(uint32_t pin)
+// Maps the legacy 0..7 channel numbers onto the variant's analog pins
+static uint32_t analogPin(uint32_t pin)
 {
-  uint32_t valueRead = 0;
-
 #if defined(PIN_A6)
   if (pin == 6) {
     pin = PIN_A6;
@@ -275,6 +274,12 @@ uint32_t analogRead(uint32_t pin)
     pin += A0;
   }
 
+  return pin;
+}
+
+// Routes the pin to the ADC, taking it back from the DAC if analogWrite() had it
+static void analogPinPrepare(uint32_t pin)
+{
   pinPeripheral(pin, PIO_ANALOG);
  //ATSAMR, for example, doesn't have a DAC
 #ifdef DAC
@@ -308,12 +313,49 @@ uint32_t analogRead(uint32_t pin)
 	  }
 
 #endif
+}
+
+#if defined(__SAMD51__)
+// Returns the ADC instance the pin is routed to, or NULL if it has none
+static Adc *analogPinADC(uint32_t pin)
+{
+  if(g_APinDescription[pin].ulPinAttribute & PIN_ATTR_ANALOG) return ADC0;
+  else if(g_APinDescription[pin].ulPinAttribute & PIN_ATTR_ANALOG_ALT) return ADC1;
+  else return NULL;
+}
+#endif
+
+// State of the conversion started by analogStart()/analogReadAsync()
+static volatile bool _asyncBusy = false;
+static volatile bool _asyncReady = false;
+static volatile uint32_t _asyncResult = 0;
+static uint32_t _asyncPin = 0;
+static analogReadCallback _asyncCallback = NULL;
+#if defined(__SAMD51__)
+static Adc *_asyncAdc = NULL;
+#endif
+
+void Analog_Handler(void);
+
+uint32_t analogRead(uint32_t pin)
+{
+  uint32_t valueRead = 0;
+
+  pin = analogPin(pin);
+
+  // The ADC is shared with the interrupt-driven path; let it finish first.
+  // Where the ADC interrupt can't run, its handler is polled instead.
+  while (_asyncBusy) {
+    if (irqBlockedHere(IRQ_CLASS_ADC)) {
+      Analog_Handler();
+    }
+  }
+
+  analogPinPrepare(pin);
 
 #if defined(__SAMD51__)
-  Adc *adc;
-  if(g_APinDescription[pin].ulPinAttribute & PIN_ATTR_ANALOG) adc = ADC0;
-  else if(g_APinDescription[pin].ulPinAttribute & PIN_ATTR_ANALOG_ALT) adc = ADC1;
-  else return 0;
+  Adc *adc = analogPinADC(pin);
+  if (adc == NULL) return 0;
 
   while( adc->SYNCBUSY.reg & ADC_SYNCBUSY_INPUTCTRL ); //wait for sync
   adc->INPUTCTRL.bit.MUXPOS = g_APinDescription[pin].ulADCChannelNumber; // Selection for the positive ADC input
@@ -395,6 +437,141 @@ uint32_t analogRead(uint32_t pin)
 }
 
 
+static bool startConversion(uint32_t pin, analogReadCallback callback)
+{
+  pin = analogPin(pin);
+
+  if (_asyncBusy) {
+    return false;
+  }
+
+#if defined(__SAMD51__)
+  Adc *adc = analogPinADC(pin);
+  if (adc == NULL) return false;
+#endif
+
+  // Only now that the conversion can't fail; the interrupt isn't on yet
+  _asyncBusy = true;
+  _asyncReady = false;
+  _asyncPin = pin;
+  _asyncCallback = callback;
+
+  analogPinPrepare(pin);
+
+#if defined(__SAMD51__)
+  _asyncAdc = adc;
+  IRQn_Type irqn = (adc == ADC0 ? ADC0_1_IRQn : ADC1_1_IRQn);
+
+  while( adc->SYNCBUSY.reg & ADC_SYNCBUSY_INPUTCTRL ); //wait for sync
+  adc->INPUTCTRL.bit.MUXPOS = g_APinDescription[pin].ulADCChannelNumber; // Selection for the positive ADC input
+
+  while( adc->SYNCBUSY.reg & ADC_SYNCBUSY_ENABLE ); //wait for sync
+  adc->CTRLA.bit.ENABLE = 0x01;             // Enable ADC
+  while( adc->SYNCBUSY.reg & ADC_SYNCBUSY_ENABLE ); //wait for sync
+
+  // Same throw-away first conversion as analogRead()
+  adc->SWTRIG.bit.START = 1;
+  adc->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  adc->SWTRIG.bit.START = 1;
+
+  NVIC_ClearPendingIRQ(irqn);
+  irqAssignPriority(irqn, IRQ_CLASS_ADC);
+  NVIC_EnableIRQ(irqn);
+  adc->INTENSET.reg = ADC_INTENSET_RESRDY;
+#else
+  syncADC();
+  ADC->INPUTCTRL.bit.MUXPOS = g_APinDescription[pin].ulADCChannelNumber; // Selection for the positive ADC input
+
+  syncADC();
+  ADC->CTRLA.bit.ENABLE = 0x01;             // Enable ADC
+
+  // Same throw-away first conversion as analogRead()
+  syncADC();
+  ADC->SWTRIG.bit.START = 1;
+  ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  syncADC();
+  ADC->SWTRIG.bit.START = 1;
+
+  NVIC_ClearPendingIRQ(ADC_IRQn);
+  irqAssignPriority(ADC_IRQn, IRQ_CLASS_ADC);
+  NVIC_EnableIRQ(ADC_IRQn);
+  ADC->INTENSET.reg = ADC_INTENSET_RESRDY;
+#endif
+
+  return true;
+}
+
+bool analogStart(uint32_t pin)
+{
+  return startConversion(pin, NULL);
+}
+
+bool analogReadAsync(uint32_t pin, analogReadCallback callback)
+{
+  return startConversion(pin, callback);
+}
+
+bool analogReady(void)
+{
+  return _asyncReady;
+}
+
+uint32_t analogResult(void)
+{
+  _asyncReady = false;
+  return _asyncResult;
+}
+
+void Analog_Handler(void)
+{
+  uint32_t valueRead;
+
+#if defined(__SAMD51__)
+  Adc *adc = _asyncAdc;
+  if (adc == NULL || adc->INTFLAG.bit.RESRDY == 0) return;
+
+  adc->INTENCLR.reg = ADC_INTENCLR_RESRDY;
+  valueRead = adc->RESULT.reg;            // Reading RESULT clears RESRDY
+
+  while( adc->SYNCBUSY.reg & ADC_SYNCBUSY_ENABLE ); //wait for sync
+  adc->CTRLA.bit.ENABLE = 0x00;             // Disable ADC
+  _asyncAdc = NULL;
+#else
+  if (ADC->INTFLAG.bit.RESRDY == 0) return;
+
+  ADC->INTENCLR.reg = ADC_INTENCLR_RESRDY;
+  valueRead = ADC->RESULT.reg;            // Reading RESULT clears RESRDY
+
+  syncADC();
+  ADC->CTRLA.bit.ENABLE = 0x00;             // Disable ADC
+#endif
+
+  _asyncResult = mapResolution(valueRead, _ADCResolution, _readResolution);
+  _asyncReady = true;
+  _asyncBusy = false;
+
+  analogReadCallback callback = _asyncCallback;
+  _asyncCallback = NULL;
+  if (callback) {
+    callback(_asyncPin, _asyncResult);
+  }
+}
+
+#if defined(__SAMD51__)
+void ADC0_1_Handler (void) __attribute__ ((weak, alias("Analog_Handler")));
+void ADC1_1_Handler (void) __attribute__ ((weak, alias("Analog_Handler")));
+#else
+void ADC_Handler (void) __attribute__ ((weak, alias("Analog_Handler")));
+#endif
+
+// Timers set up for PWM by analogWrite(), which keeps them running from then on
+static bool tcEnabled[TCC_INST_NUM+TC_INST_NUM];
+
+int analogWriteTimerInUse(uint32_t tcNum)
+{
+  return tcNum < TCC_INST_NUM+TC_INST_NUM && tcEnabled[tcNum];
+}
+
 // Right now, PWM output only works on the pins with
 // hardware support.  These are defined in the appropriate
 // pins_*.c file.  For the rest of the pins, we default
@@ -488,7 +665,6 @@ void analogWrite(uint32_t pin, uint32_t value)
 
 		uint32_t tcNum = GetTCNumber(pinDesc.ulPWMChannel);
 		uint8_t tcChannel = GetTCChannelNumber(pinDesc.ulPWMChannel);
-		static bool tcEnabled[TCC_INST_NUM+TC_INST_NUM];
 
 		if(attr & PIN_ATTR_PWM_E)
 			pinPeripheral(pin, PIO_TIMER);
@@ -583,7 +759,6 @@ void analogWrite(uint32_t pin, uint32_t value)
 
 	  uint32_t tcNum = GetTCNumber(pinDesc.ulPWMChannel);
 	  uint8_t tcChannel = GetTCChannelNumber(pinDesc.ulPWMChannel);
-	  static bool tcEnabled[TCC_INST_NUM+TC_INST_NUM];
 
 	    if (attr & PIN_ATTR_TIMER) {
 #if !(ARDUINO_SAMD_VARIANT_COMPLIANCE >= 10603)
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,6 +64,8 @@ extern void analogWrite( uint32_t ulPin, uint32_t ulValue ) ;
 
 /*
  * \brief Reads the value from the specified analog pin.
+ * Waits for a conversion started by analogStart() to finish first; where the ADC
+ * interrupt can't run, its result is then taken (and any callback called) from here.
  *
  * \param ulPin
  *
@@ -70,6 +73,45 @@ extern void analogWrite( uint32_t ulPin, uint32_t ulValue ) ;
  */
 extern uint32_t analogRead( uint32_t ulPin ) ;
 
+/*
+ * \brief Called from the ADC interrupt when a conversion started by analogReadAsync() completes.
+ *
+ * \param ulPin The pin that was converted
+ * \param ulValue The result, scaled to the analogReadResolution() setting
+ */
+typedef void (*analogReadCallback)( uint32_t ulPin, uint32_t ulValue ) ;
+
+/*
+ * \brief Starts a conversion on the specified analog pin and returns immediately.
+ * The result is signalled through the ADC result-ready interrupt instead of polling.
+ *
+ * \param ulPin
+ *
+ * \return false if a conversion is already in progress or the pin has no ADC channel.
+ */
+extern bool analogStart( uint32_t ulPin ) ;
+
+/*
+ * \brief Returns true once the conversion started by analogStart() has completed.
+ */
+extern bool analogReady( void ) ;
+
+/*
+ * \brief Returns the result of the last completed conversion and clears analogReady().
+ */
+extern uint32_t analogResult( void ) ;
+
+/*
+ * \brief Starts a conversion like analogStart() and calls callback from the ADC interrupt
+ * with the result.
+ *
+ * \param ulPin
+ * \param callback
+ *
+ * \return false if a conversion is already in progress or the pin has no ADC channel.
+ */
+extern bool analogReadAsync( uint32_t ulPin, analogReadCallback callback ) ;
+
 /*
  * \brief Set the resolution of analogRead return values. Default is 10 bits (range from 0 to 1023).
  *
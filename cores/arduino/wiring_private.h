@@ -33,6 +33,9 @@ extern "C" {
 
 int pinPeripheral( uint32_t ulPin, EPioType ulPeripheral );
 
+// Whether analogWrite() has set up the TC/TCC (by GetTCNumber()) for PWM
+int analogWriteTimerInUse( uint32_t tcNum );
+
 #ifdef __cplusplus
 } // extern "C"
 
@@ -17,6 +17,7 @@
 */
 
 #include <stdint.h>
+#include "Arduino.h"
 #include "wiring_shift.h"
 #include "wiring_digital.h"
 #include "wiring_private.h"
@@ -25,25 +26,61 @@
 extern "C"{
 #endif
 
+// The pins are resolved once per call and then driven through the PORT
+// registers directly, rather than through digitalWrite()/digitalRead()
+
+// Shortest time each clock level is held, and that data is given to settle
+// after an edge: what a 74HC595/74HC165 needs at low supply voltages.
+// Without it the clock pulse would be a single cycle at 120MHz.
+#ifndef SHIFT_SETTLE_NS
+#define SHIFT_SETTLE_NS 100
+#endif
+
+// A NOP loop iteration takes at least 3 cycles
+#define SHIFT_SETTLE_LOOPS ((VARIANT_MCK / 1000000 * SHIFT_SETTLE_NS + 2999) / 3000)
+
+static inline void shiftSettle( void )
+{
+  for ( uint32_t i = SHIFT_SETTLE_LOOPS ; i > 0 ; i-- )
+  {
+    __NOP() ;
+  }
+}
+
 uint32_t shiftIn( uint32_t ulDataPin, uint32_t ulClockPin, uint32_t ulBitOrder )
 {
+  if ( g_APinDescription[ulDataPin].ulPinType == PIO_NOT_A_PIN ||
+       g_APinDescription[ulClockPin].ulPinType == PIO_NOT_A_PIN )
+  {
+    return 0 ;
+  }
+
+  volatile uint32_t *dataIn = &PORT->Group[g_APinDescription[ulDataPin].ulPort].IN.reg ;
+  uint32_t dataMask = 1ul << g_APinDescription[ulDataPin].ulPin ;
+  PortGroup *clockPort = &PORT->Group[g_APinDescription[ulClockPin].ulPort] ;
+  uint32_t clockMask = 1ul << g_APinDescription[ulClockPin].ulPin ;
+
   uint8_t value = 0 ;
   uint8_t i ;
 
   for ( i=0 ; i < 8 ; ++i )
   {
-    digitalWrite( ulClockPin, HIGH ) ;
+    clockPort->OUTSET.reg = clockMask ;
+    shiftSettle() ;
+
+    uint8_t bit = ( *dataIn & dataMask ) ? 1 : 0 ;
 
     if ( ulBitOrder == LSBFIRST )
     {
-      value |= digitalRead( ulDataPin ) << i ;
+      value |= bit << i ;
     }
     else
     {
-      value |= digitalRead( ulDataPin ) << (7 - i) ;
+      value |= bit << (7 - i) ;
     }
 
-    digitalWrite( ulClockPin, LOW ) ;
+    clockPort->OUTCLR.reg = clockMask ;
+    shiftSettle() ;
   }
 
   return value ;
@@ -51,21 +88,45 @@ uint32_t shiftIn( uint32_t ulDataPin, uint32_t ulClockPin, uint32_t ulBitOrder )
 
 void shiftOut( uint32_t ulDataPin, uint32_t ulClockPin, uint32_t ulBitOrder, uint32_t ulVal )
 {
+  if ( g_APinDescription[ulDataPin].ulPinType == PIO_NOT_A_PIN ||
+       g_APinDescription[ulClockPin].ulPinType == PIO_NOT_A_PIN )
+  {
+    return ;
+  }
+
+  PortGroup *dataPort = &PORT->Group[g_APinDescription[ulDataPin].ulPort] ;
+  uint32_t dataMask = 1ul << g_APinDescription[ulDataPin].ulPin ;
+  PortGroup *clockPort = &PORT->Group[g_APinDescription[ulClockPin].ulPort] ;
+  uint32_t clockMask = 1ul << g_APinDescription[ulClockPin].ulPin ;
+
   uint8_t i ;
 
   for ( i=0 ; i < 8 ; i++ )
   {
+    uint32_t bit ;
+
     if ( ulBitOrder == LSBFIRST )
     {
-      digitalWrite( ulDataPin, !!(ulVal & (1 << i)) ) ;
+      bit = ulVal & (1 << i) ;
+    }
+    else
+    {
+      bit = ulVal & (1 << (7 - i)) ;
+    }
+
+    if ( bit )
+    {
+      dataPort->OUTSET.reg = dataMask ;
     }
     else
     {
-      digitalWrite( ulDataPin, !!(ulVal & (1 << (7 - i))) ) ;
+      dataPort->OUTCLR.reg = dataMask ;
     }
+    shiftSettle() ;
 
-    digitalWrite( ulClockPin, HIGH ) ;
-    digitalWrite( ulClockPin, LOW ) ;
+    clockPort->OUTSET.reg = clockMask ;
+    shiftSettle() ;
+    clockPort->OUTCLR.reg = clockMask ;
   }
 }
 
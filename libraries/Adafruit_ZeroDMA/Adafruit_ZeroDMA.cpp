@@ -65,6 +65,7 @@ Adafruit_ZeroDMA::Adafruit_ZeroDMA(void) {
     peripheralTrigger = 0;     // Software trigger only by default
     triggerAction     = DMA_TRIGGER_ACTON_TRANSACTION;
     memset(callback, 0, sizeof(callback));
+    deferredCallbacks = 0;
 }
 
 // TODO: add destructor? Should stop job, delete descriptors, free channel.
@@ -124,9 +125,7 @@ void Adafruit_ZeroDMA::_IRQhandler(uint8_t flags) {
         DMAC->CHINTFLAG.reg = DMAC_CHINTENCLR_TERR;
 #endif
         jobStatus           = DMA_STATUS_ERR_IO;
-        if(callback[DMA_CALLBACK_TRANSFER_ERROR]) {
-            callback[DMA_CALLBACK_TRANSFER_ERROR](this);
-        }
+        runCallback(DMA_CALLBACK_TRANSFER_ERROR);
     } else if(flags & DMAC_CHINTENCLR_TCMPL) {
         // Clear transfer complete flag
 #ifdef __SAMD51__
@@ -135,9 +134,7 @@ void Adafruit_ZeroDMA::_IRQhandler(uint8_t flags) {
         DMAC->CHINTFLAG.reg = DMAC_CHINTENCLR_TCMPL;
 #endif
         jobStatus           = DMA_STATUS_OK;
-        if(callback[DMA_CALLBACK_TRANSFER_DONE]) {
-            callback[DMA_CALLBACK_TRANSFER_DONE](this);
-        }
+        runCallback(DMA_CALLBACK_TRANSFER_DONE);
     } else if(flags & DMAC_CHINTENCLR_SUSP) {
         // Clear channel suspend flag
 #ifdef __SAMD51__
@@ -146,10 +143,38 @@ void Adafruit_ZeroDMA::_IRQhandler(uint8_t flags) {
         DMAC->CHINTFLAG.reg = DMAC_CHINTENCLR_SUSP;
 #endif
         jobStatus           = DMA_STATUS_SUSPEND;
-        if(callback[DMA_CALLBACK_CHANNEL_SUSPEND]) {
-            callback[DMA_CALLBACK_CHANNEL_SUSPEND](this);
-        }
+        runCallback(DMA_CALLBACK_CHANNEL_SUSPEND);
+    }
+}
+
+// Called from the IRQ handler. Each event posts its own work item, so
+// none is lost if the next one comes before the callback has run.
+void Adafruit_ZeroDMA::runCallback(dma_callback_type type) {
+    static void (* const deferred[DMA_CALLBACK_N])(void *) = {
+        runErrorCallback, runDoneCallback, runSuspendCallback
+    };
+
+    if(!callback[type]) return;
+
+    if((deferredCallbacks & (1 << type)) && workPost(deferred[type], this)) {
+        return;
     }
+    callback[type](this); // Not deferred, or the queue is full
+}
+
+void Adafruit_ZeroDMA::runErrorCallback(void *dma) {
+    Adafruit_ZeroDMA *d = (Adafruit_ZeroDMA *)dma;
+    if(d->callback[DMA_CALLBACK_TRANSFER_ERROR]) d->callback[DMA_CALLBACK_TRANSFER_ERROR](d);
+}
+
+void Adafruit_ZeroDMA::runDoneCallback(void *dma) {
+    Adafruit_ZeroDMA *d = (Adafruit_ZeroDMA *)dma;
+    if(d->callback[DMA_CALLBACK_TRANSFER_DONE]) d->callback[DMA_CALLBACK_TRANSFER_DONE](d);
+}
+
+void Adafruit_ZeroDMA::runSuspendCallback(void *dma) {
+    Adafruit_ZeroDMA *d = (Adafruit_ZeroDMA *)dma;
+    if(d->callback[DMA_CALLBACK_CHANNEL_SUSPEND]) d->callback[DMA_CALLBACK_CHANNEL_SUSPEND](d);
 }
 
 // DMA CHANNEL FUNCTIONS ---------------------------------------------------
@@ -202,17 +227,17 @@ ZeroDMAstatus Adafruit_ZeroDMA::allocate(void) {
         // Re-enable DMA controller with all priority levels
         DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
 
-        // Enable DMA interrupt at lowest priority
+        // Enable DMA interrupt, at lowest priority by default
 #ifdef __SAMD51__
         IRQn_Type irqs[] = { DMAC_0_IRQn, DMAC_1_IRQn, DMAC_2_IRQn,
                              DMAC_3_IRQn, DMAC_4_IRQn };
         for(uint8_t i=0; i<(sizeof irqs / sizeof irqs[0]); i++) {
             NVIC_EnableIRQ(irqs[i]);
-            NVIC_SetPriority(irqs[i], (1<<__NVIC_PRIO_BITS)-1);
+            irqAssignPriority(irqs[i], IRQ_CLASS_DMA);
         }
 #else
         NVIC_EnableIRQ(DMAC_IRQn);
-        NVIC_SetPriority(DMAC_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+        irqAssignPriority(DMAC_IRQn, IRQ_CLASS_DMA);
 #endif
     }
 
@@ -336,8 +361,10 @@ ZeroDMAstatus Adafruit_ZeroDMA::startJob(void) {
 // before or after channel and/or descriptors are allocated, but needs
 // to be called before job is started.
 void Adafruit_ZeroDMA::setCallback(
-  void (*cb)(Adafruit_ZeroDMA *), dma_callback_type type) {
+  void (*cb)(Adafruit_ZeroDMA *), dma_callback_type type, bool deferred) {
     callback[type] = cb;
+    if(deferred) deferredCallbacks |=  (1 << type);
+    else         deferredCallbacks &= ~(1 << type);
 }
 
 // Suspend/resume don't quite do what I thought -- avoid using for now.
@@ -30,8 +30,12 @@ class Adafruit_ZeroDMA {
   void            trigger(void) const,
                   setTrigger(uint8_t trigger),
                   setAction(dma_transfer_trigger_action action),
+                  // Callbacks run in the DMAC interrupt, or with deferred
+                  // set, after it has returned (see WorkQueue.h), for long
+                  // ones that shouldn't hold up other interrupts
                   setCallback(void (*callback)(Adafruit_ZeroDMA *) = NULL,
-                    dma_callback_type type = DMA_CALLBACK_TRANSFER_DONE),
+                    dma_callback_type type = DMA_CALLBACK_TRANSFER_DONE,
+                    bool deferred = false),
                   loop(boolean flag),
                   suspend(void) const,
                   resume(void),
@@ -61,6 +65,12 @@ class Adafruit_ZeroDMA {
   uint8_t                     peripheralTrigger;
   dma_transfer_trigger_action triggerAction;
   void                      (*callback[DMA_CALLBACK_N])(Adafruit_ZeroDMA *);
+  uint8_t                     deferredCallbacks; // Bit per callback type
+
+  void                        runCallback(dma_callback_type type);
+  static void                 runErrorCallback(void *dma);
+  static void                 runDoneCallback(void *dma);
+  static void                 runSuspendCallback(void *dma);
 };
 
 #endif // _ADAFRUIT_ZERODMA_H_
@@ -0,0 +1,46 @@
+// Checks delayMicroseconds() against cycles64(), the SysTick (SAMD21) or
+// DWT (SAMD51) cycle count behind micros(). Prints the measured length of
+// each delay and FAIL for any off by more than 1/4 us plus 1%.
+
+static const unsigned int delays[] = { 1, 2, 3, 5, 10, 20, 50, 100, 480, 1000, 2500, 10000 };
+
+static bool check(unsigned int us)
+{
+  // Fastest of a few runs, to leave out interrupts landing in one of them
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < 8; i++) {
+    uint64_t start = cycles64();
+    delayMicroseconds(us);
+    uint64_t cycles = cycles64() - start;
+    if (cycles < best) best = cycles;
+  }
+
+  // Less the cost of reading cycles64() itself
+  uint64_t start = cycles64();
+  uint64_t overhead = cycles64() - start;
+  best = best > overhead ? best - overhead : 0;
+
+  float measured = (float)best / (F_CPU / 1000000);
+  float error = measured - us;
+  bool ok = fabsf(error) <= 0.25f + us * 0.01f;
+
+  Serial.print(us);
+  Serial.print(" us: ");
+  Serial.print(measured, 3);
+  Serial.println(ok ? " us  ok" : " us  FAIL");
+  return ok;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial && millis() < 3000);
+
+  bool ok = true;
+  for (unsigned int i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+    ok &= check(delays[i]);
+  }
+  Serial.println(ok ? "PASS" : "FAIL");
+}
+
+void loop() {
+}
@@ -66,30 +66,30 @@ void DMAClass::begin()
     NVIC_DisableIRQ(DMAC_0_IRQn);
     NVIC_ClearPendingIRQ(DMAC_0_IRQn);
     NVIC_EnableIRQ(DMAC_0_IRQn);
-    NVIC_SetPriority(DMAC_0_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    irqAssignPriority(DMAC_0_IRQn, IRQ_CLASS_DMA);
 
     NVIC_DisableIRQ(DMAC_1_IRQn);
     NVIC_ClearPendingIRQ(DMAC_1_IRQn);
     NVIC_EnableIRQ(DMAC_1_IRQn);
-    NVIC_SetPriority(DMAC_1_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    irqAssignPriority(DMAC_1_IRQn, IRQ_CLASS_DMA);
 
     NVIC_DisableIRQ(DMAC_2_IRQn);
     NVIC_ClearPendingIRQ(DMAC_2_IRQn);
     NVIC_EnableIRQ(DMAC_2_IRQn);
-    NVIC_SetPriority(DMAC_2_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    irqAssignPriority(DMAC_2_IRQn, IRQ_CLASS_DMA);
 
     NVIC_DisableIRQ(DMAC_3_IRQn);
     NVIC_ClearPendingIRQ(DMAC_3_IRQn);
     NVIC_EnableIRQ(DMAC_3_IRQn);
-    NVIC_SetPriority(DMAC_3_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    irqAssignPriority(DMAC_3_IRQn, IRQ_CLASS_DMA);
 
     NVIC_DisableIRQ(DMAC_4_IRQn);
     NVIC_ClearPendingIRQ(DMAC_4_IRQn);
     NVIC_EnableIRQ(DMAC_4_IRQn);
-    NVIC_SetPriority(DMAC_4_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    irqAssignPriority(DMAC_4_IRQn, IRQ_CLASS_DMA);
 #else
     NVIC_EnableIRQ(DMAC_IRQn);
-    NVIC_SetPriority(DMAC_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    irqAssignPriority(DMAC_IRQn, IRQ_CLASS_DMA);
 #endif
   }
 
@@ -0,0 +1,48 @@
+/*
+  This sketch calibrates the ADC against its internal channels, no jumper
+  wires needed, and keeps the result in flash so later resets can apply it
+  without measuring again. Uploading a sketch erases that flash, so the
+  first run after an upload calibrates again.
+
+  Send 'c' over the serial port to force a new calibration.
+
+  This example code is in the public domain.
+*/
+
+#include "SAMD_AnalogCorrection.h"
+
+void calibrate()
+{
+  Serial.println("Calibrating ADC...");
+
+  analogReadResolution(12);
+  if (analogCalibrateAll() && analogCalibrationSave()) {
+    Serial.println("Calibration stored");
+  } else {
+    Serial.println("Calibration failed");
+  }
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while (!Serial);
+
+  if (!analogCalibrationLoad()) {
+    calibrate();
+  }
+
+  analogReadResolution(12);
+  analogReferenceCorrected(AR_DEFAULT);
+}
+
+void loop()
+{
+  if (Serial.read() == 'c') {
+    calibrate();
+  }
+
+  Serial.print("A1 = ");
+  Serial.println(analogRead(A1));
+  delay(500);
+}
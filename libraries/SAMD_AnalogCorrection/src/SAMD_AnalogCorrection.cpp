@@ -41,3 +41,420 @@ adc = ADC;
 #endif
 }
 
+#define CAL_SAMPLES         256
+#define CAL_UNITY_GAIN      0x0800
+#define CAL_MAX_GAIN        (0x1000 - 1)
+#define CAL_FULL_SCALE      4096.0f
+#define CAL_REF_COUNT       (AR_EXTERNAL + 1)
+#define CAL_MAGIC           0x43414441 // "ADAC"
+
+// Inputs: AIN0 against itself, for a differential zero, then VDDIO/4 and
+// the bandgap, single-ended
+#if defined (__SAMD51__)
+#define CAL_INPUT_ZERO      (ADC_INPUTCTRL_MUXPOS_AIN0 | ADC_INPUTCTRL_MUXNEG_AIN0)
+#else
+#define CAL_INPUT_ZERO      (ADC_INPUTCTRL_MUXPOS_PIN0 | ADC_INPUTCTRL_MUXNEG_PIN0)
+#endif
+#define CAL_INPUT_VDDIO     (ADC_INPUTCTRL_MUXPOS_SCALEDIOVCC | ADC_INPUTCTRL_MUXNEG_GND)
+#define CAL_INPUT_BANDGAP   (ADC_INPUTCTRL_MUXPOS_BANDGAP | ADC_INPUTCTRL_MUXNEG_GND)
+
+// The SAMD21 bandgap, from which its 1.0V reference is derived
+#if !defined (__SAMD51__) && !defined (CAL_BANDGAP_VOLTAGE)
+#define CAL_BANDGAP_VOLTAGE 1.1f
+#endif
+
+#define CAL_PAGE_SIZE       FLASH_PAGE_SIZE
+#if defined (__SAMD51__)
+#define CAL_ADC_COUNT       2
+#define CAL_ERASE_SIZE      (FLASH_PAGE_SIZE * 16) // one 8KB block
+#else
+#define CAL_ADC_COUNT       1
+#define CAL_ERASE_SIZE      (FLASH_PAGE_SIZE * 4)  // one 256 byte row
+#endif
+
+typedef struct {
+  uint32_t magic;
+  uint32_t valid;                               // one bit per eAnalogReference
+  int16_t  offset[CAL_ADC_COUNT][CAL_REF_COUNT];
+  uint16_t gain[CAL_ADC_COUNT][CAL_REF_COUNT];
+} AnalogCalibration;
+
+static AnalogCalibration _calibration = { CAL_MAGIC, 0, {{0}}, {{0}} };
+
+// End of the sketch image in flash: code and constants, then the initial
+// values of .data
+extern uint32_t __etext, __data_start__, __data_end__;
+
+// Flash area the table is saved to: the last erase unit of flash, below
+// the SmartEEPROM on SAMD51. It takes a whole erase unit so erasing it
+// can't touch anything else. Uploading a sketch erases the whole
+// application flash, this area included.
+static const volatile uint8_t *calibrationFlash(void)
+{
+#if defined (__SAMD51__)
+  uint32_t end = FLASH_ADDR + FLASH_SIZE - NVMCTRL->SEESTAT.bit.SBLK * 2 * CAL_ERASE_SIZE;
+#else
+  uint32_t end = FLASH_ADDR + FLASH_SIZE;
+#endif
+  return (const volatile uint8_t *)(end - CAL_ERASE_SIZE);
+}
+
+static Adc *calibrationADC(int index)
+{
+#if defined (__SAMD51__)
+  return (index == 0 ? ADC0 : ADC1);
+#else
+  (void)index;
+  return ADC;
+#endif
+}
+
+static void syncCalibrationADC(Adc *adc)
+{
+#if defined (__SAMD51__)
+  while (adc->SYNCBUSY.reg);
+#else
+  while (adc->STATUS.bit.SYNCBUSY);
+#endif
+}
+
+// Full scale with the reference and gain the core selects for mode, or 0
+// if it isn't known: a fraction of VDDANA when the reference follows the
+// supply (ratiometric), in volts when it comes from the bandgap.
+static float fullScaleOf(eAnalogReference mode, bool *ratiometric)
+{
+  *ratiometric = false;
+
+  switch (mode)
+  {
+#if defined (__SAMD51__)
+    case AR_INTERNAL1V0:  return 1.0f;
+    case AR_INTERNAL1V1:  return 1.1f;
+    case AR_INTERNAL1V2:  return 1.2f;
+    case AR_INTERNAL1V25: return 1.25f;
+    case AR_INTERNAL2V0:  return 2.0f;
+    case AR_INTERNAL2V2:  return 2.2f;
+    case AR_INTERNAL2V4:  return 2.4f;
+    case AR_INTERNAL2V5:  return 2.5f;
+    case AR_EXTERNAL:     return 0;
+    case AR_INTERNAL1V65: *ratiometric = true; return 1 / 2.0f;
+    default:              *ratiometric = true; return 1;
+#else
+    case AR_INTERNAL1V0:  return 1.0f;
+    case AR_INTERNAL1V65: *ratiometric = true; return 1 / 2.0f;
+    case AR_INTERNAL2V23: *ratiometric = true; return 1 / 1.48f;
+    case AR_DEFAULT:      *ratiometric = true; return 1; // 1/2 VDDANA with a 1/2 input gain
+    default:              return 0;
+#endif
+  }
+}
+
+// Averages CAL_SAMPLES raw 12-bit conversions of the currently selected
+// input
+static float readCalibrationAverage(Adc *adc, bool differential)
+{
+  int32_t sum = 0;
+
+  adc->CTRLA.bit.ENABLE = 1;
+  syncCalibrationADC(adc);
+
+  // The first conversion after an input or reference change is discarded
+  for (int i = -1; i < CAL_SAMPLES; i++) {
+    adc->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+    syncCalibrationADC(adc);
+    adc->SWTRIG.bit.START = 1;
+    while (adc->INTFLAG.bit.RESRDY == 0);
+
+    // Differential results are two's complement
+    int32_t value = differential ? (int16_t)adc->RESULT.reg : adc->RESULT.reg;
+    if (i >= 0) {
+      sum += value;
+    }
+  }
+
+  adc->CTRLA.bit.ENABLE = 0;
+  syncCalibrationADC(adc);
+
+  return (float)sum / CAL_SAMPLES;
+}
+
+// Averages raw conversions of the given MUXPOS/MUXNEG pair, leaving the
+// ADC set up as it was
+static float readCalibrationInput(Adc *adc, uint32_t mux, bool differential)
+{
+  syncCalibrationADC(adc);
+  adc->CTRLA.bit.ENABLE = 0;
+  syncCalibrationADC(adc);
+
+  uint32_t ctrlb = adc->CTRLB.reg;
+  uint32_t inputctrl = adc->INPUTCTRL.reg;
+  uint32_t sampctrl = adc->SAMPCTRL.reg;
+
+  // Raw 12-bit results, and the longest sampling time since the internal
+  // channels have a high source impedance
+  adc->CTRLB.bit.CORREN = 0;
+  adc->CTRLB.bit.RESSEL = ADC_CTRLB_RESSEL_12BIT_Val;
+#if !defined (__SAMD51__)
+  adc->CTRLB.bit.DIFFMODE = differential;
+#endif
+  syncCalibrationADC(adc);
+  adc->SAMPCTRL.reg = ADC_SAMPCTRL_SAMPLEN_Msk;
+  syncCalibrationADC(adc);
+
+#if defined (__SAMD51__)
+  adc->INPUTCTRL.reg = (inputctrl & ~(ADC_INPUTCTRL_MUXPOS_Msk | ADC_INPUTCTRL_MUXNEG_Msk | ADC_INPUTCTRL_DIFFMODE)) |
+                       mux | (differential ? ADC_INPUTCTRL_DIFFMODE : 0);
+#else
+  adc->INPUTCTRL.reg = (inputctrl & ~(ADC_INPUTCTRL_MUXPOS_Msk | ADC_INPUTCTRL_MUXNEG_Msk)) | mux;
+#endif
+  syncCalibrationADC(adc);
+
+  float average = readCalibrationAverage(adc, differential);
+
+  adc->SAMPCTRL.reg = sampctrl;
+  syncCalibrationADC(adc);
+  adc->INPUTCTRL.reg = inputctrl;
+  syncCalibrationADC(adc);
+  adc->CTRLB.reg = ctrlb;
+  syncCalibrationADC(adc);
+
+  return average;
+}
+
+// Offset and gain correction for the selected reference, given where the
+// single-ended input should read on a perfect ADC
+static bool measureCorrection(Adc *adc, uint32_t input, float expected, int16_t *offset, uint16_t *gain)
+{
+  // Zero: AIN0 against itself in differential mode reads zero volts
+  // whatever drives the pin. A differential LSB spans two single-ended
+  // ones, as the range covers -VREF to +VREF.
+  float zero = readCalibrationInput(adc, CAL_INPUT_ZERO, true) * 2;
+  float measured = readCalibrationInput(adc, input, false);
+
+  if (measured - zero <= 0) {
+    return false;
+  }
+
+  // The correction logic computes (RESULT - OFFSETCORR) * GAINCORR / 2048
+  int32_t correction = (int32_t)(CAL_UNITY_GAIN * expected / (measured - zero) + 0.5f);
+  if (correction < 0 || correction > CAL_MAX_GAIN) {
+    return false;
+  }
+
+  *offset = (int16_t)(zero + (zero < 0 ? -0.5f : 0.5f));
+  *gain = (uint16_t)correction;
+  return true;
+}
+
+// VDDANA in volts, measured against the bandgap with the reference on
+// VDDANA (AR_DEFAULT). That reference is corrected first with its own
+// VDDIO/4 point, which doesn't depend on the supply.
+static bool measureSupply(Adc *adc, float bandgap, float *vddana)
+{
+  int16_t offset;
+  uint16_t gain;
+
+  if (!measureCorrection(adc, CAL_INPUT_VDDIO, CAL_FULL_SCALE / 4, &offset, &gain)) {
+    return false;
+  }
+
+#if !defined (__SAMD51__)
+  bool bgouten = SYSCTRL->VREF.bit.BGOUTEN;
+  SYSCTRL->VREF.bit.BGOUTEN = 1;
+#endif
+  float measured = (readCalibrationInput(adc, CAL_INPUT_BANDGAP, false) - offset) * gain / CAL_UNITY_GAIN;
+#if !defined (__SAMD51__)
+  SYSCTRL->VREF.bit.BGOUTEN = bgouten;
+#endif
+
+  if (measured <= 0) {
+    return false;
+  }
+
+  *vddana = bandgap * CAL_FULL_SCALE / measured;
+  return true;
+}
+
+static void applyCorrection(Adc *adc, int16_t offset, uint16_t gain, bool enable)
+{
+  adc->OFFSETCORR.reg = ADC_OFFSETCORR_OFFSETCORR(offset);
+  adc->GAINCORR.reg = ADC_GAINCORR_GAINCORR(gain);
+  syncCalibrationADC(adc);
+  adc->CTRLB.bit.CORREN = enable;
+  syncCalibrationADC(adc);
+}
+
+bool analogCalibrate (eAnalogReference ref)
+{
+  bool ratiometric;
+  float fullScale = fullScaleOf(ref, &ratiometric);
+  if (fullScale <= 0 || ref >= CAL_REF_COUNT) {
+    return false;
+  }
+
+  // VDDANA in the units of fullScale. A bandgap-derived reference needs it
+  // in volts to know where VDDIO/4 should land, so it is measured against
+  // the bandgap.
+  float supply[CAL_ADC_COUNT];
+  bool ok = true;
+
+  if (ratiometric) {
+    for (int i = 0; i < CAL_ADC_COUNT; i++) {
+      supply[i] = 1;
+    }
+  } else {
+#if defined (__SAMD51__)
+    // Selecting ref first sets the SUPC VREF the bandgap channel carries;
+    // AR_DEFAULT leaves it alone
+    analogReference(ref);
+    float bandgap = fullScale;
+#else
+    float bandgap = CAL_BANDGAP_VOLTAGE;
+#endif
+    analogReference(AR_DEFAULT);
+    for (int i = 0; i < CAL_ADC_COUNT && ok; i++) {
+      ok = measureSupply(calibrationADC(i), bandgap, &supply[i]);
+    }
+  }
+
+  analogReference(ref);
+
+  for (int i = 0; i < CAL_ADC_COUNT && ok; i++) {
+    Adc *adc = calibrationADC(i);
+
+    // Where VDDIO/4 should land on a perfect ADC, with VDDIO tied to
+    // VDDANA; it has to be well inside the range to be useful as a gain
+    // point.
+    float expected = (supply[i] / 4) / fullScale * CAL_FULL_SCALE;
+    int16_t offset;
+    uint16_t gain;
+
+    ok = expected <= CAL_FULL_SCALE * 0.9f &&
+         measureCorrection(adc, CAL_INPUT_VDDIO, expected, &offset, &gain);
+    if (ok) {
+      _calibration.offset[i][ref] = offset;
+      _calibration.gain[i][ref] = gain;
+      applyCorrection(adc, offset, gain, true);
+    }
+  }
+
+  if (!ok) {
+    return false;
+  }
+
+  _calibration.valid |= (1UL << ref);
+  return true;
+}
+
+bool analogCalibrateAll (void)
+{
+  bool ok = true;
+
+  for (int ref = 0; ref < CAL_REF_COUNT; ref++) {
+    bool ratiometric;
+    if (fullScaleOf((eAnalogReference)ref, &ratiometric) > 0) {
+      ok &= analogCalibrate((eAnalogReference)ref);
+    }
+  }
+
+  analogReferenceCorrected(AR_DEFAULT);
+  return ok;
+}
+
+bool analogCalibrationSave (void)
+{
+  const volatile uint8_t *flash = calibrationFlash();
+  const uint32_t *src = (const uint32_t *)&_calibration;
+  volatile uint32_t *dst = (volatile uint32_t *)flash;
+  uint32_t words = (sizeof(_calibration) + 3) / 4;
+
+  // Not if the sketch reaches into the area
+  uint32_t imageEnd = (uint32_t)&__etext + ((uint32_t)&__data_end__ - (uint32_t)&__data_start__);
+  if (imageEnd > (uint32_t)flash) {
+    return false;
+  }
+
+  _calibration.magic = CAL_MAGIC;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+
+#if defined (__SAMD51__)
+  NVMCTRL->ADDR.reg = (uint32_t)flash;
+  NVMCTRL->CTRLB.reg = NVMCTRL_CTRLB_CMDEX_KEY | NVMCTRL_CTRLB_CMD_EB;
+  while (NVMCTRL->STATUS.bit.READY == 0);
+
+  NVMCTRL->CTRLA.bit.WMODE = NVMCTRL_CTRLA_WMODE_MAN;
+#else
+  NVMCTRL->ADDR.reg = ((uint32_t)flash) / 2;
+  NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_ER;
+  while (NVMCTRL->INTFLAG.bit.READY == 0);
+
+  NVMCTRL->CTRLB.bit.MANW = 1;
+#endif
+
+  while (words) {
+#if defined (__SAMD51__)
+    NVMCTRL->CTRLB.reg = NVMCTRL_CTRLB_CMDEX_KEY | NVMCTRL_CTRLB_CMD_PBC;
+    while (NVMCTRL->STATUS.bit.READY == 0);
+#else
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_PBC;
+    while (NVMCTRL->INTFLAG.bit.READY == 0);
+#endif
+
+    for (uint32_t i = 0; i < CAL_PAGE_SIZE / 4 && words; i++, words--) {
+      *dst++ = *src++;
+    }
+
+#if defined (__SAMD51__)
+    NVMCTRL->CTRLB.reg = NVMCTRL_CTRLB_CMDEX_KEY | NVMCTRL_CTRLB_CMD_WP;
+    while (NVMCTRL->STATUS.bit.READY == 0);
+#else
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_WP;
+    while (NVMCTRL->INTFLAG.bit.READY == 0);
+#endif
+  }
+
+#if defined (__SAMD51__)
+  // Don't let the cache hand back the erased contents
+  if (CMCC->SR.bit.CSTS) {
+    CMCC->MAINT0.reg = CMCC_MAINT0_INVALL;
+  }
+#endif
+
+  __set_PRIMASK(primask);
+
+  return memcmp((const void *)flash, &_calibration, sizeof(_calibration)) == 0;
+}
+
+bool analogCalibrationLoad (void)
+{
+  AnalogCalibration stored;
+
+  memcpy(&stored, (const void *)calibrationFlash(), sizeof(stored));
+  if (stored.magic != CAL_MAGIC) {
+    return false;
+  }
+
+  _calibration = stored;
+  return true;
+}
+
+bool analogReferenceCorrected (eAnalogReference ref)
+{
+  bool valid = (ref < CAL_REF_COUNT) && (_calibration.valid & (1UL << ref));
+
+  analogReference(ref);
+
+  for (int i = 0; i < CAL_ADC_COUNT; i++) {
+    Adc *adc = calibrationADC(i);
+
+    if (valid) {
+      applyCorrection(adc, _calibration.offset[i][ref], _calibration.gain[i][ref], true);
+    } else {
+      applyCorrection(adc, 0, CAL_UNITY_GAIN, false);
+    }
+  }
+
+  return valid;
+}
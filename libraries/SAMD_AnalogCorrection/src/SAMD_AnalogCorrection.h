@@ -22,3 +22,40 @@
 
 void analogReadCorrection (int offset, uint16_t gain);
 
+/*
+ * Measures the ADC offset and gain error for the given reference (and the
+ * input gain the core pairs with it) without any external wiring, then
+ * applies and remembers the correction.
+ *
+ * Offset is taken from a differential conversion of AIN0 against itself,
+ * which reads zero whatever is on the pin. Gain is taken from the internal
+ * VDDIO/4 channel. For the VDDANA-derived references only its ratio to the
+ * reference matters; for the bandgap-derived ones VDDANA is first measured
+ * against the bandgap, so no supply voltage has to be given. AR_EXTERNAL
+ * can't be calibrated this way and returns false. On the SAMD51 both ADC0
+ * and ADC1 are calibrated.
+ */
+bool analogCalibrate (eAnalogReference ref);
+
+/* Runs analogCalibrate() for every internal reference of the chip. */
+bool analogCalibrateAll (void);
+
+/*
+ * Stores the corrections measured so far in the last erase unit of flash
+ * (below the SmartEEPROM on SAMD51), so resets and power cycles can load
+ * them instead of measuring again. Uploading a sketch erases the whole
+ * application flash, so they last only until the next upload. Returns
+ * false if the sketch itself reaches into that area.
+ */
+bool analogCalibrationSave (void);
+
+/* Loads corrections stored by analogCalibrationSave(); false if there are none. */
+bool analogCalibrationLoad (void);
+
+/*
+ * Selects the reference like analogReference() and applies its stored
+ * correction. Returns false (correction disabled) if that reference hasn't
+ * been calibrated.
+ */
+bool analogReferenceCorrected (eAnalogReference ref);
+
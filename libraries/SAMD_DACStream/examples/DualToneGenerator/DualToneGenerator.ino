@@ -0,0 +1,58 @@
+/*
+  Plays a continuous sine wave on DAC0 (and a second one, a fifth higher,
+  on DAC1 of a SAMD51) at 44.1kHz. Samples are synthesised into one half
+  of the buffer while DMA plays the other, so the CPU is interrupted once
+  per half-buffer rather than once per sample.
+
+  This example code is in the public domain.
+*/
+
+#include "SAMD_DACStream.h"
+
+#define SAMPLE_RATE   44100
+#define FRAMES        512      // per buffer, split into two halves
+
+uint16_t samples[FRAMES * DACSTREAM_CHANNELS];
+
+float phase[2];
+const float step[2] = {
+  2.0f * PI * 440.0f / SAMPLE_RATE,
+  2.0f * PI * 660.0f / SAMPLE_RATE
+};
+
+void refill(uint16_t *buffer, uint32_t frames)
+{
+  const float mid = (1 << DACSTREAM_RESOLUTION) / 2 - 1;
+
+  for (uint32_t n = 0; n < frames; n++) {
+    for (int ch = 0; ch < DACSTREAM_CHANNELS; ch++) {
+      *buffer++ = (uint16_t)(mid + mid * sinf(phase[ch]));
+      phase[ch] += step[ch];
+      if (phase[ch] >= 2.0f * PI) {
+        phase[ch] -= 2.0f * PI;
+      }
+    }
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  if (!DACStream.begin(SAMPLE_RATE, DACSTREAM_CHANNELS)) {
+    Serial.println("Sample rate not supported");
+    while (1);
+  }
+
+  // Prime both halves before the first sample is converted
+  refill(samples, FRAMES);
+  DACStream.play(samples, FRAMES, refill);
+}
+
+void loop()
+{
+  Serial.print("Playing at ");
+  Serial.print(DACStream.sampleRate());
+  Serial.println(" Hz");
+  delay(1000);
+}
@@ -0,0 +1,339 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "SAMD_DACStream.h"
+#include "wiring_private.h"
+#include "EventSystem.h"
+
+#if defined(__SAMD51__)
+#define WAIT_TC_SYNC(tc, mask)  while ((tc)->COUNT16.SYNCBUSY.reg & (mask))
+#define WAIT_DAC_SYNC()         while (DAC->SYNCBUSY.bit.ENABLE || DAC->SYNCBUSY.bit.SWRST)
+#else
+#define WAIT_TC_SYNC(tc, mask)  while ((tc)->COUNT16.STATUS.bit.SYNCBUSY)
+#define WAIT_DAC_SYNC()         while (DAC->STATUS.bit.SYNCBUSY)
+#endif
+
+DACStreamClass::DACStreamClass() :
+  _sampleRate(0),
+  _channels(1),
+  _eventChannel(-1),
+  _begun(false),
+  _allocated(false),
+  _playing(false),
+  _half(0),
+  _samples(NULL),
+  _frames(0),
+  _callback(NULL)
+{
+  for (int i = 0; i < DACSTREAM_CHANNELS; i++) {
+    _desc[i][0] = _desc[i][1] = NULL;
+  }
+}
+
+bool DACStreamClass::begin(uint32_t sampleRate, uint8_t channels)
+{
+  if (channels == 0 || channels > DACSTREAM_CHANNELS || sampleRate == 0) {
+    return false;
+  }
+
+  if (_begun) {
+    end();
+  }
+
+  _channels = channels;
+
+  if (!configureTimer(sampleRate)) {
+    return false;
+  }
+
+  pinPeripheral(PIN_DAC0, PIO_ANALOG);
+#if defined(__SAMD51__)
+  if (channels == 2) {
+    pinPeripheral(PIN_DAC1, PIO_ANALOG);
+  }
+#endif
+
+  if (!configureEvents(true)) {
+    return false;
+  }
+  configureDAC(true);
+
+  _begun = true;
+  return true;
+}
+
+void DACStreamClass::end()
+{
+  if (!_begun) {
+    return;
+  }
+
+  stop();
+
+  configureEvents(false);
+  // Leave the channels enabled so analogWrite() keeps working on them
+  configureDAC(false);
+
+  _begun = false;
+}
+
+bool DACStreamClass::configureTimer(uint32_t sampleRate)
+{
+  Tc *tc = DACSTREAM_TC;
+
+  // Smallest prescaler that keeps the period within 16 bits
+  static const uint8_t shifts[] = {0, 1, 2, 3, 4, 6, 8, 10};
+  uint32_t prescaler;
+  uint32_t ticks = 0;
+  for (prescaler = 0; prescaler < sizeof(shifts); prescaler++) {
+    ticks = (F_CPU >> shifts[prescaler]) / sampleRate;
+    if (ticks <= 0x10000) {
+      break;
+    }
+  }
+  if (prescaler == sizeof(shifts) || ticks < 2) {
+    return false;
+  }
+
+#if defined(__SAMD51__)
+  GCLK->PCHCTRL[DACSTREAM_TC_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK0_Val | (1 << GCLK_PCHCTRL_CHEN_Pos);
+  while (GCLK->PCHCTRL[DACSTREAM_TC_GCLK_ID].bit.CHEN == 0);
+
+  tc->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  WAIT_TC_SYNC(tc, TC_SYNCBUSY_SWRST);
+
+  tc->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER(prescaler);
+  tc->COUNT16.WAVE.reg = TC_WAVE_WAVEGEN_MFRQ;
+  tc->COUNT16.CC[0].reg = ticks - 1;
+  WAIT_TC_SYNC(tc, TC_SYNCBUSY_CC0);
+#else
+  GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID(DACSTREAM_TC_GCM));
+  while (GCLK->STATUS.bit.SYNCBUSY);
+
+  tc->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  WAIT_TC_SYNC(tc, 0);
+  while (tc->COUNT16.CTRLA.bit.SWRST);
+
+  tc->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER(prescaler);
+  WAIT_TC_SYNC(tc, 0);
+  tc->COUNT16.CC[0].reg = ticks - 1;
+  WAIT_TC_SYNC(tc, 0);
+#endif
+
+  // The overflow event is the sample clock; no interrupt is needed
+  tc->COUNT16.EVCTRL.reg = TC_EVCTRL_OVFEO;
+
+  _sampleRate = (F_CPU >> shifts[prescaler]) / ticks;
+  return true;
+}
+
+bool DACStreamClass::configureEvents(bool enable)
+{
+  if (!enable) {
+    EventSystem.release(_eventChannel);
+    _eventChannel = -1;
+    return true;
+  }
+
+  // The overflow event is the sample clock for the DAC start input(s)
+  _eventChannel = EventSystem.allocate();
+  if (_eventChannel < 0) {
+    return false;
+  }
+#if defined(__SAMD51__)
+  EventSystem.addUser(_eventChannel, EVSYS_ID_USER_DAC_START_0);
+  if (_channels == 2) {
+    EventSystem.addUser(_eventChannel, EVSYS_ID_USER_DAC_START_1);
+  }
+#else
+  EventSystem.addUser(_eventChannel, EVSYS_ID_USER_DAC_START);
+#endif
+  return EventSystem.route(_eventChannel, DACSTREAM_TC_EVGEN);
+}
+
+void DACStreamClass::configureDAC(bool enable)
+{
+  // EVCTRL and DACCTRL are enable-protected
+  WAIT_DAC_SYNC();
+  DAC->CTRLA.bit.ENABLE = 0;
+  WAIT_DAC_SYNC();
+
+#if defined(__SAMD51__)
+  uint8_t startEvents = 0;
+  for (int i = 0; i < _channels; i++) {
+    // GCLK_DAC runs at 12MHz, which needs the fastest current setting
+    DAC->DACCTRL[i].bit.CCTRL = DAC_DACCTRL_CCTRL_CC12M_Val;
+    DAC->DACCTRL[i].bit.ENABLE = 1;
+    startEvents |= DAC_EVCTRL_STARTEI0 << i;
+  }
+  DAC->EVCTRL.reg = enable ? startEvents : 0;
+
+  DAC->CTRLA.bit.ENABLE = 1;
+  WAIT_DAC_SYNC();
+
+  for (int i = 0; i < _channels; i++) {
+    while (!(DAC->STATUS.reg & (DAC_STATUS_READY0 << i)));
+  }
+#else
+  DAC->EVCTRL.bit.STARTEI = enable;
+
+  DAC->CTRLA.bit.ENABLE = 1;
+  WAIT_DAC_SYNC();
+#endif
+}
+
+bool DACStreamClass::play(uint16_t *samples, uint32_t frames, DACStreamCallback callback)
+{
+  if (!_begun || _playing || frames == 0 || (callback && (frames & 1))) {
+    return false;
+  }
+
+  if (!_allocated) {
+    // The DMA library only ever appends descriptors, so build both
+    // halves once per channel and re-point them for every play().
+    for (int i = 0; i < DACSTREAM_CHANNELS; i++) {
+#if defined(__SAMD51__)
+      void *dst = (void *)&DAC->DATABUF[i].reg;
+      _dma[i].setTrigger(DAC_DMAC_ID_EMPTY_0 + i);
+#else
+      void *dst = (void *)&DAC->DATABUF.reg;
+      _dma[i].setTrigger(DAC_DMAC_ID_EMPTY);
+#endif
+      _dma[i].setAction(DMA_TRIGGER_ACTON_BEAT);
+      if (_dma[i].allocate() != DMA_STATUS_OK) {
+        releaseDMA();
+        return false;
+      }
+
+      for (int d = 0; d < 2; d++) {
+        _desc[i][d] = _dma[i].addDescriptor(samples, dst, 1, DMA_BEAT_SIZE_HWORD, true, false,
+                                            DMA_ADDRESS_INCREMENT_STEP_SIZE_1, DMA_STEPSEL_SRC);
+        if (!_desc[i][d]) {
+          releaseDMA();
+          return false;
+        }
+      }
+    }
+    _allocated = true;
+  }
+
+  _samples = samples;
+  _frames = frames;
+  _callback = callback;
+  _half = 0;
+
+  for (int i = 0; i < _channels; i++) {
+    DmacDescriptor **desc = _desc[i];
+    // Interleaved frames: each channel reads every _channels-th sample
+    uint32_t step = (_channels == 2) ? DMA_ADDRESS_INCREMENT_STEP_SIZE_2 : DMA_ADDRESS_INCREMENT_STEP_SIZE_1;
+    desc[0]->BTCTRL.bit.STEPSIZE = step;
+    desc[1]->BTCTRL.bit.STEPSIZE = step;
+
+    // Only the last channel reports progress; all channels advance on the
+    // same conversion event.
+    uint8_t blockAction = (callback && i == _channels - 1) ? DMA_BLOCK_ACTION_INT : DMA_BLOCK_ACTION_NOACT;
+    desc[0]->BTCTRL.bit.BLOCKACT = blockAction;
+    desc[1]->BTCTRL.bit.BLOCKACT = blockAction;
+
+    if (callback) {
+      uint32_t half = frames / 2;
+      _dma[i].changeDescriptor(desc[0], samples + i, NULL, half);
+      _dma[i].changeDescriptor(desc[1], samples + half * _channels + i, NULL, half);
+      desc[0]->DESCADDR.reg = (uint32_t)desc[1];
+      desc[1]->DESCADDR.reg = (uint32_t)desc[0];
+    } else {
+      _dma[i].changeDescriptor(desc[0], samples + i, NULL, frames);
+      desc[0]->DESCADDR.reg = (uint32_t)desc[0];
+    }
+  }
+
+  _dma[_channels - 1].setCallback(onDmaDone, DMA_CALLBACK_TRANSFER_DONE, true);
+
+  for (int i = 0; i < _channels; i++) {
+    _dma[i].startJob();
+  }
+
+  _playing = true;
+
+  // DATABUF is empty, so DMA preloads the first sample before the first
+  // overflow starts a conversion.
+  Tc *tc = DACSTREAM_TC;
+  tc->COUNT16.CTRLA.bit.ENABLE = 1;
+#if defined(__SAMD51__)
+  WAIT_TC_SYNC(tc, TC_SYNCBUSY_ENABLE);
+#else
+  WAIT_TC_SYNC(tc, 0);
+#endif
+
+  return true;
+}
+
+// Frees the channels and descriptors a failed play() got so far; the
+// next play() allocates them again from scratch
+void DACStreamClass::releaseDMA()
+{
+  for (int i = 0; i < DACSTREAM_CHANNELS; i++) {
+    _dma[i].free();
+    // Only the second descriptor was allocated here, the first is the
+    // DMA library's own for the channel
+    free(_desc[i][1]);
+    _desc[i][0] = _desc[i][1] = NULL;
+    _dma[i] = Adafruit_ZeroDMA();
+  }
+
+  _allocated = false;
+}
+
+void DACStreamClass::stop()
+{
+  if (!_playing) {
+    return;
+  }
+
+  // Stop the sample clock first so no conversion consumes a stale sample
+  Tc *tc = DACSTREAM_TC;
+  tc->COUNT16.CTRLA.bit.ENABLE = 0;
+#if defined(__SAMD51__)
+  WAIT_TC_SYNC(tc, TC_SYNCBUSY_ENABLE);
+#else
+  WAIT_TC_SYNC(tc, 0);
+#endif
+
+  for (int i = 0; i < _channels; i++) {
+    _dma[i].abort();
+  }
+
+  _playing = false;
+}
+
+void DACStreamClass::onDmaDone(Adafruit_ZeroDMA *)
+{
+  DACStreamClass &self = DACStream;
+
+  if (!self._callback) {
+    return;
+  }
+
+  uint32_t half = self._frames / 2;
+  uint16_t *done = self._samples + (self._half ? half * self._channels : 0);
+  self._half ^= 1;
+
+  self._callback(done, half);
+}
+
+DACStreamClass DACStream;
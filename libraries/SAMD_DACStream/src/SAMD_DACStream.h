@@ -0,0 +1,106 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#if !defined(DAC)
+#error "SAMD_DACStream requires a device with a DAC"
+#endif
+
+#include <Adafruit_ZeroDMA.h>
+
+/*
+ * The sample clock. Its overflow event starts every DAC conversion, so it
+ * can't be shared with analogWrite() PWM on pins routed to the same TC.
+ */
+#if defined(__SAMD51__)
+#define DACSTREAM_TC              TC2
+#define DACSTREAM_TC_GCLK_ID      TC2_GCLK_ID
+#define DACSTREAM_TC_EVGEN        EVSYS_ID_GEN_TC2_OVF
+#define DACSTREAM_CHANNELS        2
+#define DACSTREAM_RESOLUTION      12
+#else
+#define DACSTREAM_TC              TC3
+#define DACSTREAM_TC_GCM          GCM_TCC2_TC3
+#define DACSTREAM_TC_EVGEN        EVSYS_ID_GEN_TC3_OVF
+#define DACSTREAM_CHANNELS        1
+#define DACSTREAM_RESOLUTION      10
+#endif
+
+/*
+ * Called from PendSV, just after the DMA interrupt (see WorkQueue.h), when
+ * half of the buffer passed to play() has been sent to the DAC and may be
+ * refilled. frames is the number of
+ * sample frames (one sample per channel) at samples.
+ */
+typedef void (*DACStreamCallback)(uint16_t *samples, uint32_t frames);
+
+class DACStreamClass
+{
+public:
+  DACStreamClass();
+
+  /*
+   * Sets up the DAC channel(s) and the sample clock. With channels == 2
+   * (SAMD51 only) samples are interleaved left/right, DAC0 then DAC1.
+   * Returns false if the rate or channel count can't be generated.
+   */
+  bool begin(uint32_t sampleRate, uint8_t channels = 1);
+  void end();
+
+  /*
+   * Starts output of frames sample frames from samples, right-aligned to
+   * resolution() bits.
+   *
+   * Without a callback the buffer is replayed forever with no CPU
+   * involvement, which suits fixed waveforms. With a callback the buffer
+   * is treated as two halves: the callback runs as each half finishes so
+   * it can be refilled while the other half plays (frames must be even).
+   */
+  bool play(uint16_t *samples, uint32_t frames, DACStreamCallback callback = NULL);
+  void stop();
+  bool isPlaying() const { return _playing; }
+
+  uint32_t sampleRate() const { return _sampleRate; }
+  uint8_t resolution() const { return DACSTREAM_RESOLUTION; }
+
+private:
+  static void onDmaDone(Adafruit_ZeroDMA *dma);
+  bool configureTimer(uint32_t sampleRate);
+  bool configureEvents(bool enable);
+  void configureDAC(bool enable);
+  void releaseDMA();
+
+  uint32_t _sampleRate;
+  uint8_t _channels;
+  int _eventChannel;
+  bool _begun;
+  bool _allocated;
+  volatile bool _playing;
+  uint8_t _half;
+  uint16_t *_samples;
+  uint32_t _frames;
+  DACStreamCallback _callback;
+
+  Adafruit_ZeroDMA _dma[DACSTREAM_CHANNELS];
+  DmacDescriptor *_desc[DACSTREAM_CHANNELS][2];
+};
+
+extern DACStreamClass DACStream;
@@ -0,0 +1,54 @@
+/*
+  Samples a voltage and a current channel on ADC0 and ADC1 at the same
+  instant and prints the average real power of each block.
+
+  A2 must be routed to ADC0 and A3 to ADC1 on your board; change the pins
+  below if your variant maps them differently.
+
+  This example code is in the public domain.
+*/
+
+#include "SAMD_DualADC.h"
+
+#define VOLTAGE_PIN   A2
+#define CURRENT_PIN   A3
+#define BLOCK_SIZE    256
+
+uint16_t voltage[2 * BLOCK_SIZE];
+uint16_t current[2 * BLOCK_SIZE];
+
+volatile int64_t powerSum;
+volatile bool blockReady = false;
+
+void onBlock(uint16_t *v, uint16_t *i, uint32_t count)
+{
+  int64_t sum = 0;
+
+  for (uint32_t n = 0; n < count; n++) {
+    sum += ((int32_t)v[n] - 512) * ((int32_t)i[n] - 512);
+  }
+
+  powerSum = sum / count;
+  blockReady = true;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  if (!DualADC.begin(VOLTAGE_PIN, CURRENT_PIN)) {
+    Serial.println("Pins are not on ADC0/ADC1");
+    while (1);
+  }
+
+  DualADC.start(voltage, current, 2 * BLOCK_SIZE, onBlock, true);
+}
+
+void loop()
+{
+  if (blockReady) {
+    blockReady = false;
+    Serial.println((long)powerSum);
+  }
+}
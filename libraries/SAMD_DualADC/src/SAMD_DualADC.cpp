@@ -0,0 +1,269 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "SAMD_DualADC.h"
+#include "wiring_private.h"
+
+static inline void syncADC(Adc *adc, uint32_t mask)
+{
+  while (adc->SYNCBUSY.reg & mask);
+}
+
+DualADCClass::DualADCClass() :
+  _pinA(0),
+  _pinB(0),
+  _begun(false),
+  _allocated(false),
+  _busy(false),
+  _continuous(false),
+  _half(0),
+  _bufA(NULL),
+  _bufB(NULL),
+  _count(0),
+  _callback(NULL)
+{
+  _descA[0] = _descA[1] = NULL;
+  _descB[0] = _descB[1] = NULL;
+}
+
+bool DualADCClass::begin(uint32_t pinA, uint32_t pinB)
+{
+  if (!(g_APinDescription[pinA].ulPinAttribute & PIN_ATTR_ANALOG) ||
+      !(g_APinDescription[pinB].ulPinAttribute & PIN_ATTR_ANALOG_ALT)) {
+    return false;
+  }
+
+  _pinA = pinA;
+  _pinB = pinB;
+
+  pinPeripheral(pinA, PIO_ANALOG);
+  pinPeripheral(pinB, PIO_ANALOG);
+
+  configure(false);
+  _begun = true;
+
+  // The first conversion after the reference is changed must not be used.
+  uint32_t a, b;
+  read(&a, &b);
+
+  return true;
+}
+
+void DualADCClass::end()
+{
+  stop();
+
+  syncADC(ADC0, ADC_SYNCBUSY_ENABLE);
+  ADC0->CTRLA.bit.ENABLE = 0;
+  syncADC(ADC0, ADC_SYNCBUSY_ENABLE);
+  syncADC(ADC1, ADC_SYNCBUSY_ENABLE);
+  ADC1->CTRLA.bit.ENABLE = 0;
+  syncADC(ADC1, ADC_SYNCBUSY_ENABLE);
+
+  // Hand ADC1 back to analogRead() as an independent instance
+  ADC1->CTRLA.bit.SLAVEEN = 0;
+  ADC0->CTRLB.bit.FREERUN = 0;
+  ADC1->CTRLB.bit.FREERUN = 0;
+  syncADC(ADC0, ADC_SYNCBUSY_CTRLB);
+  syncADC(ADC1, ADC_SYNCBUSY_CTRLB);
+
+  _begun = false;
+}
+
+void DualADCClass::configure(bool freeRun)
+{
+  Adc *adcs[] = {ADC0, ADC1};
+  uint32_t pins[] = {_pinA, _pinB};
+
+  for (int i = 0; i < 2; i++) {
+    syncADC(adcs[i], ADC_SYNCBUSY_ENABLE);
+    adcs[i]->CTRLA.bit.ENABLE = 0;
+    syncADC(adcs[i], ADC_SYNCBUSY_ENABLE);
+  }
+
+  // CTRLA is enable-protected; the slave takes its clock and start
+  // trigger from the master once SLAVEEN is set.
+  ADC1->CTRLA.bit.SLAVEEN = 1;
+  ADC0->CTRLA.bit.DUALSEL = ADC_CTRLA_DUALSEL_BOTH_Val;
+
+  for (int i = 0; i < 2; i++) {
+    adcs[i]->INPUTCTRL.bit.MUXPOS = g_APinDescription[pins[i]].ulADCChannelNumber;
+    syncADC(adcs[i], ADC_SYNCBUSY_INPUTCTRL);
+
+    adcs[i]->CTRLB.bit.FREERUN = freeRun;
+    syncADC(adcs[i], ADC_SYNCBUSY_CTRLB);
+
+    adcs[i]->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  }
+
+  ADC0->CTRLA.bit.ENABLE = 1;
+  syncADC(ADC0, ADC_SYNCBUSY_ENABLE);
+  ADC1->CTRLA.bit.ENABLE = 1;
+  syncADC(ADC1, ADC_SYNCBUSY_ENABLE);
+}
+
+void DualADCClass::read(uint32_t *a, uint32_t *b)
+{
+  if (!_begun || _busy) {
+    return;
+  }
+
+  ADC0->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  ADC1->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+
+  // Starting the master starts the slave on the same clock edge
+  ADC0->SWTRIG.bit.START = 1;
+
+  while (ADC0->INTFLAG.bit.RESRDY == 0 || ADC1->INTFLAG.bit.RESRDY == 0);
+  *a = ADC0->RESULT.reg;
+  *b = ADC1->RESULT.reg;
+}
+
+bool DualADCClass::start(uint16_t *a, uint16_t *b, uint32_t count, DualADCCallback callback, bool continuous)
+{
+  if (!_begun || _busy || count == 0 || (continuous && (count & 1))) {
+    return false;
+  }
+
+  Adafruit_ZeroDMA *dmas[] = {&_dmaA, &_dmaB};
+  DmacDescriptor **descs[] = {_descA, _descB};
+  uint16_t *bufs[] = {a, b};
+  Adc *adcs[] = {ADC0, ADC1};
+  const uint8_t triggers[] = {ADC0_DMAC_ID_RESRDY, ADC1_DMAC_ID_RESRDY};
+
+  if (!_allocated) {
+    // The DMA library only ever appends descriptors, so build both
+    // halves once and re-point them for every start().
+    for (int i = 0; i < 2; i++) {
+      dmas[i]->setTrigger(triggers[i]);
+      dmas[i]->setAction(DMA_TRIGGER_ACTON_BEAT);
+      if (dmas[i]->allocate() != DMA_STATUS_OK) {
+        releaseDMA();
+        return false;
+      }
+
+      void *src = (void *)&adcs[i]->RESULT.reg;
+      descs[i][0] = dmas[i]->addDescriptor(src, bufs[i], 1, DMA_BEAT_SIZE_HWORD, false, true);
+      descs[i][1] = dmas[i]->addDescriptor(src, bufs[i], 1, DMA_BEAT_SIZE_HWORD, false, true);
+      if (!descs[i][0] || !descs[i][1]) {
+        releaseDMA();
+        return false;
+      }
+      descs[i][0]->BTCTRL.bit.BLOCKACT = DMA_BLOCK_ACTION_INT;
+      descs[i][1]->BTCTRL.bit.BLOCKACT = DMA_BLOCK_ACTION_INT;
+    }
+
+    // Only the slave's channel reports completion: its result for a
+    // trigger is ready no earlier than the master's.
+    _dmaB.setCallback(onDmaDone, DMA_CALLBACK_TRANSFER_DONE, true);
+    _allocated = true;
+  }
+
+  _bufA = a;
+  _bufB = b;
+  _count = count;
+  _callback = callback;
+  _continuous = continuous;
+  _half = 0;
+
+  for (int i = 0; i < 2; i++) {
+    if (continuous) {
+      uint32_t half = count / 2;
+      dmas[i]->changeDescriptor(descs[i][0], NULL, bufs[i], half);
+      dmas[i]->changeDescriptor(descs[i][1], NULL, bufs[i] + half, half);
+      descs[i][0]->DESCADDR.reg = (uint32_t)descs[i][1];
+      descs[i][1]->DESCADDR.reg = (uint32_t)descs[i][0];
+    } else {
+      dmas[i]->changeDescriptor(descs[i][0], NULL, bufs[i], count);
+      descs[i][0]->DESCADDR.reg = 0;
+    }
+  }
+
+  _dmaA.startJob();
+  _dmaB.startJob();
+
+  _busy = true;
+  configure(true);
+  ADC0->SWTRIG.bit.START = 1;
+
+  return true;
+}
+
+// Undoes a partial allocation in start(), so a retry doesn't take new
+// channels while the old ones stay in use
+void DualADCClass::releaseDMA()
+{
+  Adafruit_ZeroDMA *dmas[] = {&_dmaA, &_dmaB};
+  DmacDescriptor **descs[] = {_descA, _descB};
+
+  for (int i = 0; i < 2; i++) {
+    dmas[i]->free();
+    // The first descriptor of a channel belongs to the DMA library; the
+    // second was allocated for it
+    free(descs[i][1]);
+    descs[i][0] = descs[i][1] = NULL;
+  }
+
+  // Descriptors can't be removed from an object, only left behind with it
+  _dmaA = Adafruit_ZeroDMA();
+  _dmaB = Adafruit_ZeroDMA();
+  _allocated = false;
+}
+
+void DualADCClass::stop()
+{
+  if (!_busy) {
+    return;
+  }
+
+  ADC0->CTRLB.bit.FREERUN = 0;
+  ADC1->CTRLB.bit.FREERUN = 0;
+  syncADC(ADC0, ADC_SYNCBUSY_CTRLB);
+  syncADC(ADC1, ADC_SYNCBUSY_CTRLB);
+
+  _dmaA.abort();
+  _dmaB.abort();
+
+  _busy = false;
+}
+
+void DualADCClass::onDmaDone(Adafruit_ZeroDMA *)
+{
+  DualADCClass &self = DualADC;
+
+  if (self._continuous) {
+    uint32_t half = self._count / 2;
+    uint32_t offset = self._half ? half : 0;
+    self._half ^= 1;
+
+    if (self._callback) {
+      self._callback(self._bufA + offset, self._bufB + offset, half);
+    }
+  } else {
+    // Stop free-running before handing the buffers over
+    ADC0->CTRLB.bit.FREERUN = 0;
+    ADC1->CTRLB.bit.FREERUN = 0;
+    self._busy = false;
+
+    if (self._callback) {
+      self._callback(self._bufA, self._bufB, self._count);
+    }
+  }
+}
+
+DualADCClass DualADC;
@@ -0,0 +1,87 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#if !defined(__SAMD51__)
+#error "SAMD_DualADC requires a SAMD51 (two ADC instances)"
+#endif
+
+#include <Adafruit_ZeroDMA.h>
+
+/*
+ * Called when a block of paired samples is ready. a[] holds the ADC0
+ * results and b[] the ADC1 results; a[i] and b[i] were converted on the
+ * same trigger. In continuous mode the buffers passed to start() are used
+ * as two halves, and this is called once per half, from PendSV just after
+ * the DMA interrupt (see WorkQueue.h).
+ */
+typedef void (*DualADCCallback)(uint16_t *a, uint16_t *b, uint32_t count);
+
+class DualADCClass
+{
+public:
+  DualADCClass();
+
+  /*
+   * Puts ADC0 (master) and ADC1 (slave) in lockstep. pinA must be
+   * routed to ADC0 (PIN_ATTR_ANALOG) and pinB to ADC1 (PIN_ATTR_ANALOG_ALT).
+   * Returns false if either pin can't reach its ADC.
+   */
+  bool begin(uint32_t pinA, uint32_t pinB);
+  void end();
+
+  /* Runs one paired conversion and blocks until both results are ready. */
+  void read(uint32_t *a, uint32_t *b);
+
+  /*
+   * Free-runs both ADCs and streams results into a[] and b[] with DMA.
+   * One-shot mode fills count samples and calls callback once; continuous
+   * mode loops forever, calling callback for each half of the buffers
+   * (count must then be even).
+   */
+  bool start(uint16_t *a, uint16_t *b, uint32_t count, DualADCCallback callback, bool continuous = false);
+  void stop();
+  bool isBusy() const { return _busy; }
+
+private:
+  static void onDmaDone(Adafruit_ZeroDMA *dma);
+  void configure(bool freeRun);
+  void releaseDMA();
+
+  uint32_t _pinA;
+  uint32_t _pinB;
+  bool _begun;
+  bool _allocated;
+  volatile bool _busy;
+  bool _continuous;
+  uint8_t _half;
+  uint16_t *_bufA;
+  uint16_t *_bufB;
+  uint32_t _count;
+  DualADCCallback _callback;
+
+  Adafruit_ZeroDMA _dmaA;
+  Adafruit_ZeroDMA _dmaB;
+  DmacDescriptor *_descA[2];
+  DmacDescriptor *_descB[2];
+};
+
+extern DualADCClass DualADC;
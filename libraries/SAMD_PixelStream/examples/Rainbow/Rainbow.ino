@@ -0,0 +1,60 @@
+/*
+  Scrolls a rainbow along a strip of WS2812 (NeoPixel) LEDs wired to the
+  MOSI pin of the SPI header. Each frame is encoded while DMA sends the
+  previous one, and interrupts stay enabled throughout, so Serial keeps
+  printing the frame rate.
+
+  This example code is in the public domain.
+*/
+
+#include "SAMD_PixelStream.h"
+
+#define NUM_PIXELS  300
+
+PixelStream strip(NUM_PIXELS, SPI, PIXEL_GRB);
+
+uint32_t wheel(uint8_t pos)
+{
+  if (pos < 85) {
+    return PixelStream::Color(255 - pos * 3, pos * 3, 0);
+  }
+  if (pos < 170) {
+    pos -= 85;
+    return PixelStream::Color(0, 255 - pos * 3, pos * 3);
+  }
+  pos -= 170;
+  return PixelStream::Color(pos * 3, 0, 255 - pos * 3);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  if (!strip.begin()) {
+    Serial.println("Not enough memory for the strip");
+    while (1);
+  }
+}
+
+void loop()
+{
+  static uint8_t offset = 0;
+  static uint32_t frames = 0;
+  static uint32_t lastReport = 0;
+
+  for (uint16_t n = 0; n < strip.numPixels(); n++) {
+    // Dimmed to keep the current draw down
+    uint32_t c = wheel(offset + n * 256 / strip.numPixels());
+    strip.setPixelColor(n, (c >> 19) & 0x1F, (c >> 11) & 0x1F, (c >> 3) & 0x1F);
+  }
+  strip.show();
+  offset++;
+  frames++;
+
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    Serial.print(frames);
+    Serial.println(" frames/s");
+    frames = 0;
+  }
+}
@@ -0,0 +1,293 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "SAMD_PixelStream.h"
+
+// Most bytes a single DMA descriptor can move
+#define DESCRIPTOR_MAX_COUNT 65535
+
+// Position of red, green, blue and white in a pixel, per PixelOrder
+static const uint8_t orderOffsets[][4] = {
+  { 0, 1, 2, 0 },   // PIXEL_RGB
+  { 1, 0, 2, 0 },   // PIXEL_GRB
+  { 1, 2, 0, 0 },   // PIXEL_BRG
+  { 0, 1, 2, 3 },   // PIXEL_RGBW
+  { 1, 0, 2, 3 },   // PIXEL_GRBW
+};
+
+// The 12 SPI bits sending each 4 bits of pixel data, MSB first
+static const uint16_t nibbleCode[16] = {
+  0x924, 0x926, 0x934, 0x936, 0x9A4, 0x9A6, 0x9B4, 0x9B6,
+  0xD24, 0xD26, 0xD34, 0xD36, 0xDA4, 0xDA6, 0xDB4, 0xDB6,
+};
+
+// PixelStream using each DMA channel, for the completion callback
+static PixelStream *streams[DMAC_CH_NUM];
+
+PixelStream::PixelStream(uint16_t numPixels, SPIClass &spi, PixelOrder order) :
+  _spi(&spi),
+  _numPixels(numPixels),
+  _bytesPerPixel(order >= PIXEL_RGBW ? 4 : 3),
+  _offsets(orderOffsets[order]),
+  _pixels(NULL),
+  _encodedSize(0),
+  _back(0),
+  _doubleBuffered(false),
+  _begun(false),
+  _allocated(false),
+  _busy(false),
+  _desc(NULL),
+  _descCount(0)
+{
+  _encoded[0] = _encoded[1] = NULL;
+}
+
+PixelStream::~PixelStream()
+{
+  end();
+  if (_allocated) {
+    releaseDMA();
+  }
+  free(_pixels);
+}
+
+bool PixelStream::allocateDMA()
+{
+  _descCount = (_encodedSize + DESCRIPTOR_MAX_COUNT - 1) / DESCRIPTOR_MAX_COUNT;
+  _desc = (DmacDescriptor **)calloc(_descCount, sizeof(DmacDescriptor *));
+  if (!_desc) {
+    return false;
+  }
+
+  // The DMA library only ever appends descriptors, so the chain is built
+  // once and re-pointed at the buffer to send by every show()
+  _dma.setTrigger(_spi->getDMAC_ID_TX());
+  _dma.setAction(DMA_TRIGGER_ACTON_BEAT);
+  if (_dma.allocate() != DMA_STATUS_OK) {
+    free(_desc);
+    _desc = NULL;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < _descCount; i++) {
+    _desc[i] = _dma.addDescriptor(_encoded[0], (void *)_spi->getDataRegister(), 1,
+                                  DMA_BEAT_SIZE_BYTE, true, false);
+    if (!_desc[i]) {
+      releaseDMA();
+      return false;
+    }
+  }
+
+  streams[_dma.getChannel()] = this;
+  _dma.setCallback(onDmaDone);
+  _allocated = true;
+  return true;
+}
+
+void PixelStream::releaseDMA()
+{
+  if (_allocated) {
+    streams[_dma.getChannel()] = NULL;
+  }
+  _dma.free();
+
+  // The DMA library can't drop descriptors: all but the first, which it
+  // keeps per channel, came from the heap. A fresh object starts a new
+  // chain on whichever channel it gets next.
+  for (uint8_t i = 1; i < _descCount; i++) {
+    free(_desc[i]);
+  }
+  free(_desc);
+  _desc = NULL;
+  _descCount = 0;
+  _dma = Adafruit_ZeroDMA();
+
+  _allocated = false;
+}
+
+bool PixelStream::begin(bool doubleBuffered)
+{
+  if (_numPixels == 0) {
+    return false;
+  }
+
+  if (_begun) {
+    end();
+  }
+
+  if (!_pixels) {
+    _pixels = (uint8_t *)calloc(_numPixels, _bytesPerPixel);
+    if (!_pixels) {
+      return false;
+    }
+  }
+
+  // The trailing zeros, the latch, are never overwritten
+  _encodedSize = (uint32_t)_numPixels * _bytesPerPixel * 3 + PIXELSTREAM_LATCH_BYTES;
+  _encoded[0] = (uint8_t *)calloc(_encodedSize, 1);
+  _encoded[1] = doubleBuffered ? (uint8_t *)calloc(_encodedSize, 1) : _encoded[0];
+  if (!_encoded[0] || !_encoded[1] || (!_allocated && !allocateDMA())) {
+    free(_encoded[0]);
+    if (doubleBuffered) {
+      free(_encoded[1]);
+    }
+    _encoded[0] = _encoded[1] = NULL;
+    return false;
+  }
+
+  _spi->begin();
+  _spi->beginTransaction(SPISettings(PIXELSTREAM_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+
+  _doubleBuffered = doubleBuffered;
+  _back = 0;
+  _begun = true;
+  return true;
+}
+
+void PixelStream::end()
+{
+  if (!_begun) {
+    return;
+  }
+
+  waitForShow();
+
+  _spi->endTransaction();
+  _spi->end();
+
+  free(_encoded[0]);
+  if (_doubleBuffered) {
+    free(_encoded[1]);
+  }
+  _encoded[0] = _encoded[1] = NULL;
+
+  _begun = false;
+}
+
+void PixelStream::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w)
+{
+  if (n >= _numPixels || !_pixels) {
+    return;
+  }
+
+  uint8_t *p = _pixels + (uint32_t)n * _bytesPerPixel;
+  p[_offsets[0]] = r;
+  p[_offsets[1]] = g;
+  p[_offsets[2]] = b;
+  if (_bytesPerPixel == 4) {
+    p[_offsets[3]] = w;
+  }
+}
+
+void PixelStream::setPixelColor(uint16_t n, uint32_t color)
+{
+  setPixelColor(n, color >> 16, color >> 8, color, color >> 24);
+}
+
+uint32_t PixelStream::getPixelColor(uint16_t n) const
+{
+  if (n >= _numPixels || !_pixels) {
+    return 0;
+  }
+
+  const uint8_t *p = _pixels + (uint32_t)n * _bytesPerPixel;
+  return Color(p[_offsets[0]], p[_offsets[1]], p[_offsets[2]],
+               _bytesPerPixel == 4 ? p[_offsets[3]] : 0);
+}
+
+void PixelStream::fill(uint32_t color, uint16_t first, uint16_t count)
+{
+  if (first >= _numPixels) {
+    return;
+  }
+
+  if (count == 0 || count > _numPixels - first) {
+    count = _numPixels - first;
+  }
+
+  for (uint16_t n = first; n < first + count; n++) {
+    setPixelColor(n, color);
+  }
+}
+
+void PixelStream::clear()
+{
+  if (_pixels) {
+    memset(_pixels, 0, (uint32_t)_numPixels * _bytesPerPixel);
+  }
+}
+
+void PixelStream::encode(uint8_t *dst) const
+{
+  const uint8_t *src = _pixels;
+  const uint8_t *end = _pixels + (uint32_t)_numPixels * _bytesPerPixel;
+
+  while (src < end) {
+    uint8_t v = *src++;
+    uint32_t code = ((uint32_t)nibbleCode[v >> 4] << 12) | nibbleCode[v & 0x0F];
+    *dst++ = code >> 16;
+    *dst++ = code >> 8;
+    *dst++ = code;
+  }
+}
+
+void PixelStream::waitForShow() const
+{
+  while (_busy) {
+    yield();
+  }
+}
+
+bool PixelStream::show()
+{
+  if (!_begun) {
+    return false;
+  }
+
+  uint8_t *buffer = _encoded[_back];
+
+  // Single-buffered, the frame being sent is the one about to be encoded
+  if (!_doubleBuffered) {
+    waitForShow();
+  }
+  encode(buffer);
+  waitForShow();
+
+  uint32_t remaining = _encodedSize;
+  for (uint8_t i = 0; i < _descCount; i++) {
+    uint32_t count = remaining > DESCRIPTOR_MAX_COUNT ? DESCRIPTOR_MAX_COUNT : remaining;
+    _dma.changeDescriptor(_desc[i], buffer + (_encodedSize - remaining), NULL, count);
+    remaining -= count;
+  }
+
+  _busy = true;
+  if (_dma.startJob() != DMA_STATUS_OK) {
+    _busy = false;
+    return false;
+  }
+
+  if (_doubleBuffered) {
+    _back ^= 1;
+  }
+  return true;
+}
+
+void PixelStream::onDmaDone(Adafruit_ZeroDMA *dma)
+{
+  streams[dma->getChannel()]->_busy = false;
+}
@@ -0,0 +1,113 @@
+/*
+  Copyright (c) 2015 Arduino LLC.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <Adafruit_ZeroDMA.h>
+
+/*
+ * Each WS2812 bit (1.25us) is sent as three SPI bits at 2.4MHz: 100 for a
+ * 0 and 110 for a 1, so each pixel byte takes three bytes of the encoded
+ * buffer. The low gap that latches a frame is sent as trailing zeros.
+ */
+#define PIXELSTREAM_SPI_CLOCK     2400000
+#define PIXELSTREAM_LATCH_BYTES   90        // 300us, enough for WS2812B
+
+// Byte order of the pixels on the wire
+enum PixelOrder {
+  PIXEL_RGB,
+  PIXEL_GRB,
+  PIXEL_BRG,
+  PIXEL_RGBW,
+  PIXEL_GRBW,
+};
+
+/*
+ * Drives a WS2812 (NeoPixel) strip from the MOSI pin of an SPI port, with
+ * the frame sent by DMA while interrupts stay enabled.
+ *
+ * The strip's data line must be on the MOSI pin of spi, and the port is
+ * taken over: other devices can't share it, and its SCK and MISO pins are
+ * muxed to the SERCOM as well. A board whose onboard pixels aren't on a
+ * SERCOM pad needs an SPIClass of its own built on the right SERCOM.
+ *
+ * Memory use is the pixel buffer plus one encoded buffer (or two, when
+ * double-buffered) of three bytes per pixel byte.
+ */
+class PixelStream
+{
+public:
+  PixelStream(uint16_t numPixels, SPIClass &spi = SPI, PixelOrder order = PIXEL_GRB);
+  ~PixelStream();
+
+  /*
+   * Allocates the buffers and a DMA channel and starts the SPI port.
+   * Double-buffered, show() encodes the next frame while the last one is
+   * still being sent; single-buffered, it waits for it first.
+   */
+  bool begin(bool doubleBuffered = true);
+  void end();
+
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+  void setPixelColor(uint16_t n, uint32_t color);     // 0xWWRRGGBB
+  uint32_t getPixelColor(uint16_t n) const;
+  void fill(uint32_t color, uint16_t first = 0, uint16_t count = 0);
+  void clear();
+
+  /*
+   * Encodes the pixels and starts sending them. Returns as soon as DMA
+   * has started; the pixels may be changed again right away.
+   */
+  bool show();
+
+  // True while a frame is being sent
+  bool isBusy() const { return _busy; }
+
+  uint16_t numPixels() const { return _numPixels; }
+  uint8_t *getPixels() const { return _pixels; }
+
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+    return ((uint32_t)w << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+private:
+  static void onDmaDone(Adafruit_ZeroDMA *dma);
+  bool allocateDMA();
+  void releaseDMA();
+  void encode(uint8_t *dst) const;
+  void waitForShow() const;
+
+  SPIClass *_spi;
+  uint16_t _numPixels;
+  uint8_t _bytesPerPixel;
+  const uint8_t *_offsets;
+  uint8_t *_pixels;
+  uint8_t *_encoded[2];
+  uint32_t _encodedSize;
+  uint8_t _back;
+  bool _doubleBuffered;
+  bool _begun;
+  bool _allocated;
+  volatile bool _busy;
+
+  Adafruit_ZeroDMA _dma;
+  DmacDescriptor **_desc;
+  uint8_t _descCount;
+};
@@ -382,8 +382,9 @@ void SPIClass::transfer(const void* txbuf, void* rxbuf, size_t count,
 }
 
 // Waits for a prior in-background DMA transfer to complete.
+// Other tasks get to run meanwhile (see TaskSwitch.h).
 void SPIClass::waitForTransfer(void) {
-    while(dma_busy);
+    while(dma_busy) yield();
 }
 
 void SPIClass::attachInterrupt() {
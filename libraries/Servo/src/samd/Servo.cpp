@@ -21,6 +21,11 @@
 #include <Arduino.h>
 #include <Servo.h>
 
+#if defined(_useTCC)
+#include <PWM.h>
+#include "wiring_private.h"
+#endif
+
 #if defined(__SAMD51__)
  // Different prescalers depending on FCPU (avoid overflowing 16-bit counter)
  #if(F_CPU > 200000000)
@@ -52,6 +57,16 @@ static volatile int8_t currentServoIndex[_Nbr_16timers];   // index for the serv
 #define SERVO_MIN() (MIN_PULSE_WIDTH - this->min * 4)   // minimum value in uS for this servo
 #define SERVO_MAX() (MAX_PULSE_WIDTH - this->max * 4)   // maximum value in uS for this servo
 
+#if defined(_useTCC)
+static uint8_t servoTcc[MAX_SERVOS];                       // TCC number + 1 pulsing each servo, 0 if pulsed by the timer interrupt
+static uint8_t tccServoCount[TCC_INST_NUM];                // servos attached to each TCC
+static uint32_t tccPeriod[TCC_INST_NUM];                   // TCC counts per refresh interval
+
+#define SERVO_ON_TCC(_servo_nbr) (servoTcc[_servo_nbr] != 0)
+#else
+#define SERVO_ON_TCC(_servo_nbr) (false)
+#endif
+
 // Referenced in SAMD21 code only, no harm in defining regardless
 #define WAIT_TC16_REGS_SYNC(x) while(x->COUNT16.STATUS.bit.SYNCBUSY);
 
@@ -84,8 +99,10 @@ void Servo_Handler(timer16_Sequence_t timer, Tc *tc, uint8_t channel, uint8_t in
         }
     }
 
-    // Select the next servo controlled by this timer
-    currentServoIndex[timer]++;
+    // Select the next servo controlled by this timer, passing over those pulsed by a TCC
+    do {
+        currentServoIndex[timer]++;
+    } while (currentServoIndex[timer] < SERVOS_PER_TIMER && SERVO_ON_TCC(SERVO_INDEX(timer, currentServoIndex[timer])));
 
     if (SERVO_INDEX(timer, currentServoIndex[timer]) < ServoCount && currentServoIndex[timer] < SERVOS_PER_TIMER) {
         if (SERVO(timer, currentServoIndex[timer]).Pin.isActive == true) {   // check if activated
@@ -236,7 +253,7 @@ static void _initISR(Tc *tc, uint8_t channel, uint32_t id, IRQn_Type irqn, uint8
     // TODO this should be changed if more than one channel per timer is used by the Servo library
     NVIC_DisableIRQ(irqn);
     NVIC_ClearPendingIRQ(irqn);
-    NVIC_SetPriority(irqn, 0);
+    irqAssignPriority(irqn, IRQ_CLASS_SERVO);
     NVIC_EnableIRQ(irqn);
 
     // Enable the match channel interrupt request
@@ -279,12 +296,94 @@ static boolean isTimerActive(timer16_Sequence_t timer)
 {
   // returns true if any servo is active on this timer
   for(uint8_t channel=0; channel < SERVOS_PER_TIMER; channel++) {
-    if(SERVO(timer,channel).Pin.isActive == true)
+    if(SERVO(timer,channel).Pin.isActive == true && !SERVO_ON_TCC(SERVO_INDEX(timer,channel)))
       return true;
   }
   return false;
 }
 
+#if defined(_useTCC)
+// CC channel of the TCC driving pin, as PWM::write() picks it
+static uint8_t tccChannel(uint32_t pin)
+{
+  uint32_t pwmChannel = g_APinDescription[pin].ulPWMChannel;
+
+#if defined(__SAMD51__)
+  static const uint8_t ccNum[] = {
+    TCC0_CC_NUM, TCC1_CC_NUM, TCC2_CC_NUM,
+ #ifdef TCC3_CC_NUM
+    TCC3_CC_NUM,
+ #endif
+ #ifdef TCC4_CC_NUM
+    TCC4_CC_NUM,
+ #endif
+  };
+  return GetTCChannelNumber(pwmChannel) % ccNum[GetTCNumber(pwmChannel)];
+#else
+  return GetTCChannelNumber(pwmChannel);
+#endif
+}
+
+static bool attachTCC(uint8_t servoIndex, uint32_t pin)
+{
+  int32_t pwmChannel = g_APinDescription[pin].ulPWMChannel;
+
+  if (pwmChannel == NOT_ON_PWM || GetTCNumber(pwmChannel) >= TCC_INST_NUM)
+    return false;
+
+  uint8_t tcNum = GetTCNumber(pwmChannel);
+
+  // Resetting the TCC would stop analogWrite() on its other pins
+  if (analogWriteTimerInUse(tcNum))
+    return false;
+
+  // One pulse width per CC channel
+  for (uint8_t i = 0; i < ServoCount; i++) {
+    if (i != servoIndex && servoTcc[i] == tcNum + 1 && tccChannel(servos[i].Pin.nbr) == tccChannel(pin))
+      return false;
+  }
+
+  PWM pwm(pin);
+  if (tccServoCount[tcNum] == 0) {
+    if (!pwm.begin(1000000UL / REFRESH_INTERVAL))
+      return false;
+    tccPeriod[tcNum] = pwm.period();
+  } else if (!pwm.attach(pin)) {
+    return false;
+  }
+
+  tccServoCount[tcNum]++;
+  servoTcc[servoIndex] = tcNum + 1;
+  return true;
+}
+
+static void writeTCC(uint8_t servoIndex, uint32_t us)
+{
+  uint32_t pin = servos[servoIndex].Pin.nbr;
+  PWM pwm(pin);
+
+  // Buffered, so the pulse in progress isn't cut short
+  pwm.write(pin, (uint64_t)us * tccPeriod[servoTcc[servoIndex] - 1] / REFRESH_INTERVAL);
+}
+
+static void detachTCC(uint8_t servoIndex)
+{
+  uint8_t tcNum = servoTcc[servoIndex] - 1;
+  uint32_t pin = servos[servoIndex].Pin.nbr;
+  PWM pwm(pin);
+
+  servoTcc[servoIndex] = 0;
+  // analogWrite() may have set the TCC up again since the servos took it
+  if (--tccServoCount[tcNum] == 0 && !analogWriteTimerInUse(tcNum))
+    pwm.end();
+  else
+    pwm.write(pin, 0);
+
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);
+}
+#endif
+
 /****************** end of static functions ******************************/
 
 Servo::Servo()
@@ -307,11 +406,22 @@ uint8_t Servo::attach(int pin, int min, int max)
   timer16_Sequence_t timer;
 
   if (this->servoIndex < MAX_SERVOS) {
+#if defined(_useTCC)
+    if (SERVO_ON_TCC(this->servoIndex))
+      detachTCC(this->servoIndex);
+#endif
     pinMode(pin, OUTPUT);                                   // set servo pin to output
     servos[this->servoIndex].Pin.nbr = pin;
     // todo min/max check: abs(min - MIN_PULSE_WIDTH) /4 < 128
     this->min  = (MIN_PULSE_WIDTH - min)/4; //resolution of min/max is 4 uS
     this->max  = (MAX_PULSE_WIDTH - max)/4;
+#if defined(_useTCC)
+    if (attachTCC(this->servoIndex, pin)) {
+      writeTCC(this->servoIndex, readMicroseconds());
+      servos[this->servoIndex].Pin.isActive = true;
+      return this->servoIndex;
+    }
+#endif
     // initialize the timer if it has not already been initialized
     timer = SERVO_INDEX_TO_TIMER(servoIndex);
     if (isTimerActive(timer) == false) {
@@ -326,6 +436,14 @@ void Servo::detach()
 {
   timer16_Sequence_t timer;
 
+#if defined(_useTCC)
+  if (this->servoIndex < MAX_SERVOS && SERVO_ON_TCC(this->servoIndex)) {
+    detachTCC(this->servoIndex);
+    servos[this->servoIndex].Pin.isActive = false;
+    return;
+  }
+#endif
+
   servos[this->servoIndex].Pin.isActive = false;
   timer = SERVO_INDEX_TO_TIMER(servoIndex);
   if(isTimerActive(timer) == false) {
@@ -359,6 +477,11 @@ void Servo::writeMicroseconds(int value)
     else if (value > SERVO_MAX())
       value = SERVO_MAX();
 
+#if defined(_useTCC)
+    if (SERVO_ON_TCC(channel))
+      writeTCC(channel, value);
+#endif
+
     value = value - TRIM_DURATION;
     value = usToTicks(value);  // convert to ticks after compensating for interrupt overhead
     servos[channel].ticks = value;
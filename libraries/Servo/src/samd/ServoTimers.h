@@ -33,6 +33,15 @@
  */
 
 // For SAMD:
+
+// Uncomment to have servos on pins driven by a TCC pulsed by the TCC
+// itself, in NPWM at the refresh rate with one CC channel per servo, so
+// their pulses take no CPU time and don't jitter with other interrupts.
+// The TCC is taken over while servos use it. A TCC already running
+// analogWrite() PWM is left alone, and servos on its pins, or sharing a CC
+// channel with another servo, use the interrupt driven timer below.
+//#define _useTCC
+
 #define _useTimer1
 //#define _useTimer2   // <- TODO do not activate until the code in Servo.cpp has been changed in order
                        //         to manage more than one channel per timer on the SAMD architecture
@@ -32,6 +32,8 @@ TwoWire::TwoWire(SERCOM * s, uint8_t pinSDA, uint8_t pinSCL)
   this->_uc_pinSDA=pinSDA;
   this->_uc_pinSCL=pinSCL;
   transmissionBegun = false;
+  receivePending = false;
+  receiveRunning = false;
 }
 
 void TwoWire::begin(void) {
@@ -219,16 +221,37 @@ void TwoWire::onService(void)
       sercom->prepareAckBitWIRE();
       sercom->prepareCommandBitsWire(0x03);
 
-      //Calling onReceiveCallback, if exists
+      //Calling onReceiveCallback, if exists, once the IRQ has returned
       if(onReceiveCallback)
       {
-        onReceiveCallback(available());
+        if(!receivePending)
+        {
+          receivePending = true;
+          if(!workPost(deferredReceive, this))
+          {
+            deferredReceive(this);
+          }
+        }
+      }
+      else
+      {
+        rxBuffer.clear();
       }
-      
-      rxBuffer.clear();
     }
     else if(sercom->isAddressMatch())  //Address Match
     {
+      // The reply may depend on a message onReceiveCallback hasn't had yet
+      if(sercom->isMasterReadOperationWIRE() && receivePending)
+      {
+        if(!claimReceive())
+        {
+          // It is running in PendSV: stretch the clock until it is done
+          sercom->disableAddressMatchInterruptWIRE();
+          return;
+        }
+        receive();
+      }
+
       sercom->prepareAckBitWIRE();
       sercom->prepareCommandBitsWire(0x03);
 
@@ -257,7 +280,9 @@ void TwoWire::onService(void)
 
         transmissionBegun = sercom->sendDataSlaveWIRE(c);
       } else { //Received data
-        if (rxBuffer.isFull()) {
+        // Until the last message has been handed to onReceiveCallback
+        // there is no room for the next one
+        if (rxBuffer.isFull() || receivePending) {
           sercom->prepareNackBitWIRE(); 
         } else {
           //Store data
@@ -272,6 +297,45 @@ void TwoWire::onService(void)
   }
 }
 
+// Only one of PendSV and the IRQ hands a message to onReceiveCallback
+bool TwoWire::claimReceive(void)
+{
+  bool claimed = false;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if(receivePending && !receiveRunning)
+  {
+    receiveRunning = true;
+    claimed = true;
+  }
+  __set_PRIMASK(primask);
+
+  return claimed;
+}
+
+void TwoWire::receive(void)
+{
+  onReceiveCallback(available());
+
+  rxBuffer.clear();
+  receiveRunning = false;
+  receivePending = false;
+}
+
+void TwoWire::deferredReceive(void *wire)
+{
+  TwoWire *w = (TwoWire *)wire;
+
+  if(w->claimReceive())
+  {
+    w->receive();
+  }
+
+  // Answers a read request held off while the callback ran
+  w->sercom->enableAddressMatchInterruptWIRE();
+}
+
 #if WIRE_INTERFACES_COUNT > 0
   /* In case new variant doesn't define these macros,
    * we put here the ones for Arduino Zero.
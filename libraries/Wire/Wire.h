@@ -81,6 +81,14 @@ class TwoWire : public Stream
     void (*onRequestCallback)(void);
     void (*onReceiveCallback)(int);
 
+    // onReceiveCallback is deferred out of the SERCOM IRQ (see WorkQueue.h),
+    // unless a read request comes first
+    volatile bool receivePending;
+    volatile bool receiveRunning;
+    bool claimReceive(void);
+    void receive(void);
+    static void deferredReceive(void *wire);
+
     // TWI clock frequency
     static const uint32_t TWI_CLOCK = 100000;
 };